@@ -0,0 +1,456 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/* Замеры стоимости компиляции.  Для каждого сочетания числа
+плейсхолдеров, длины источника, набора типов и пути сканирования
+генерируется единица трансляции, которая компилируется отдельным
+процессом.  Записываются время компиляции (реальное и процессорное),
+пиковая память компилятора, число инстанцирований и размер объектного
+файла.  Результат -- JSON-массив, по одному объекту на случай.
+
+Инстанцирования считаются для Clang по -ftime-trace (функции и
+классы), для GCC -- по -fdump-tree-original отдельного прохода
+-fsyntax-only вне замера времени (только шаблоны функций, прошедшие
+обработку тел; consteval-функции и классы не учитываются).  Способ
+записывается в поле instantiations_method; для прочих компиляторов --
+"unavailable" и null в случаях.
+
+При --import yes единицы трансляции подключают библиотеку через
+import stdx.scan вместо #include "scan.hpp"; флаги, указывающие
+компилятору собранный интерфейс модуля, передаются через --flags.
+
+Запуск: compile_bench [--out FILE] [--work DIR] [--cxx PATH] [--include DIR]
+    [--flags "..."] [--counts 1,2,...] [--lengths 0,4096,...]
+    [--mixes int,mixed,string] [--paths consteval,runtime] [--import yes|no] */
+
+extern char** environ;
+
+namespace
+{
+#ifndef SCAN_CXX_COMPILER
+#define SCAN_CXX_COMPILER "c++"
+#endif
+
+#ifndef SCAN_CXX_COMPILER_ID
+#define SCAN_CXX_COMPILER_ID ""
+#endif
+
+#ifndef SCAN_INCLUDE_DIR
+#define SCAN_INCLUDE_DIR "include"
+#endif
+
+    struct options
+    {
+        std::string out;
+        std::filesystem::path work =
+            std::filesystem::temp_directory_path() / "scan_compile_bench";
+        std::string cxx = SCAN_CXX_COMPILER;
+        std::string compiler_id = SCAN_CXX_COMPILER_ID;
+        std::string include = SCAN_INCLUDE_DIR;
+        std::vector<std::string> flags{ "-std=c++23", "-O2" };
+        std::vector<size_t> counts{ 1, 2, 4, 8, 16, 32, 64, 128 };
+        std::vector<size_t> lengths{ 0, 4096, 65536 };
+        std::vector<std::string> mixes{ "int", "mixed", "string" };
+        std::vector<std::string> paths{ "consteval", "runtime" };
+        bool import_module = false;
+    };
+
+    struct bench_case
+    {
+        size_t n_placeholders;
+        size_t source_length;
+        std::string mix;
+        std::string path;
+    };
+
+    //=== Генерация единиц трансляции ===
+    // Спецификатор, тип и значение i-го плейсхолдера для набора типов
+    struct placeholder_kind
+    {
+        const char* spec;
+        const char* type;
+        const char* value;
+    };
+
+    placeholder_kind kind_of(const std::string& mix, size_t i)
+    {
+        constexpr placeholder_kind kinds[] = {
+            { "%d", "int", "-12345" },
+            { "%f", "double", "3.25" },
+            { "%s", "std::string_view", "word" },
+            { "%u", "unsigned", "67890" } };
+
+        if (mix == "int") return kinds[0];
+        if (mix == "string") return kinds[2];
+        return kinds[i % 4];
+    }
+
+    // Строковый литерал, разбитый на части для длинных строк
+    std::string to_literal(std::string_view text)
+    {
+        constexpr size_t chunk = 512;
+
+        std::string out;
+        for (size_t pos = 0; pos < text.size() || !pos; pos += chunk)
+        {
+            out += "\n    \"";
+            out += text.substr(pos, chunk);
+            out += '"';
+        }
+        return out;
+    }
+
+    /* Формат вида "k0_xxx={%d} k1_xxx={%f} ...": длина источника
+    добирается заполнителем в разделителях, поэтому растёт и текст,
+    по которому ищутся разделители */
+    std::string generate(const bench_case& c, const bool import_module)
+    {
+        std::string format;
+        std::string source;
+        std::string types;
+
+        size_t base = 0;
+        for (size_t i = 0; i < c.n_placeholders; ++i)
+        {
+            base += std::to_string(i).size() + 4 +
+                std::string_view{ kind_of(c.mix, i).value }.size();
+        }
+
+        const size_t pad = (c.n_placeholders && c.source_length > base)
+            ? (c.source_length - base) / c.n_placeholders
+            : 0;
+
+        for (size_t i = 0; i < c.n_placeholders; ++i)
+        {
+            const placeholder_kind kind = kind_of(c.mix, i);
+            const std::string sep = (i ? " k" : "k") + std::to_string(i) +
+                "_" + std::string(pad, 'x') + "=";
+
+            format += sep + "{" + kind.spec + "}";
+            source += sep + kind.value;
+            types += std::string{ ", " } + kind.type;
+        }
+
+        std::ostringstream out;
+        if (import_module)
+        {
+            out << "#include <string_view>\n\n"
+                << "import stdx.scan;\n\n";
+        }
+        else out << "#include \"scan.hpp\"\n\n";
+        out << "using namespace stdx;\n\n";
+
+        if (c.path == "include")
+        {
+            out << "int touch() { return 0; }\n";
+            return out.str();
+        }
+
+        out << "constexpr format_string<" << to_literal(format) << "> format;\n\n";
+
+        if (c.path == "consteval")
+        {
+            out << "constexpr fixed_string source{" << to_literal(source) << "};\n\n"
+                << "constexpr auto result = scan<format, source" << types << ">();\n\n"
+                << "const void* touch() { return &result; }\n";
+        }
+        else
+        {
+            out << "bool touch(std::string_view source)\n{\n"
+                << "    return scan<format" << types << ">(source).has_value();\n}\n";
+        }
+        return out.str();
+    }
+
+    //=== Запуск компилятора ===
+    struct run_result
+    {
+        bool ok;
+        double wall_s;
+        double cpu_s;
+        long max_rss_kb;
+    };
+
+    // Запуск процесса с учётом ресурсов, потраченных им самим
+    run_result run(const std::vector<std::string>& args,
+        const std::filesystem::path& log)
+    {
+        std::vector<char*> argv;
+        for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, 2, log.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        pid_t pid;
+        const int spawned = posix_spawnp(&pid, argv[0], &actions, nullptr,
+            argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (spawned) return { false, 0, 0, 0 };
+
+        int status = 0;
+        rusage usage{};
+        wait4(pid, &status, 0, &usage);
+
+        const auto stop = std::chrono::steady_clock::now();
+
+        const auto seconds = [](const timeval& tv)
+            {
+                return tv.tv_sec + tv.tv_usec / 1e6;
+            };
+
+        return {
+            WIFEXITED(status) && WEXITSTATUS(status) == 0,
+            std::chrono::duration<double>(stop - start).count(),
+            seconds(usage.ru_utime) + seconds(usage.ru_stime),
+            usage.ru_maxrss };
+    }
+
+    // Число событий инстанцирования в отчёте -ftime-trace
+    long count_instantiations(const std::filesystem::path& trace)
+    {
+        std::ifstream in{ trace };
+        if (!in) return -1;
+
+        const std::string text{ std::istreambuf_iterator<char>{ in }, {} };
+        long out = 0;
+        for (const std::string_view event : { "\"name\":\"InstantiateFunction\"",
+            "\"name\":\"InstantiateClass\"" })
+        {
+            for (size_t pos = text.find(event); pos != std::string::npos;
+                pos = text.find(event, pos + event.size()))
+            {
+                ++out;
+            }
+        }
+        return out;
+    }
+
+    /* Число инстанцирований шаблонов функций в дампе
+    -fdump-tree-original: заголовок каждой функции -- строка
+    ";; Function ...", у инстанцирований -- с "[with ...]" */
+    long count_dumped_instantiations(const std::filesystem::path& dump)
+    {
+        std::ifstream in{ dump };
+        if (!in) return -1;
+
+        long out = 0;
+        for (std::string line; std::getline(in, line);)
+        {
+            out += line.starts_with(";; Function") &&
+                line.find("[with ") != std::string::npos;
+        }
+        return out;
+    }
+
+    //=== Разбор параметров ===
+    std::vector<std::string> split(std::string_view list)
+    {
+        std::vector<std::string> out;
+        while (!list.empty())
+        {
+            const size_t comma = list.find(',');
+            out.emplace_back(list.substr(0, comma));
+            list.remove_prefix((comma == std::string_view::npos) ? list.size() : comma + 1);
+        }
+        return out;
+    }
+
+    std::vector<size_t> split_numbers(std::string_view list)
+    {
+        std::vector<size_t> out;
+        for (const std::string& item : split(list)) out.push_back(std::stoul(item));
+        return out;
+    }
+
+    options parse_options(int argc, char* argv[])
+    {
+        options out;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const std::string_view arg = argv[i];
+            const char* value = argv[i + 1];
+
+            if (arg == "--out") out.out = value;
+            else if (arg == "--work") out.work = value;
+            else if (arg == "--cxx") out.cxx = value, out.compiler_id.clear();
+            else if (arg == "--include") out.include = value;
+            else if (arg == "--flags")
+            {
+                out.flags.clear();
+                std::istringstream flags{ value };
+                for (std::string flag; flags >> flag;) out.flags.push_back(flag);
+            }
+            else if (arg == "--counts") out.counts = split_numbers(value);
+            else if (arg == "--lengths") out.lengths = split_numbers(value);
+            else if (arg == "--mixes") out.mixes = split(value);
+            else if (arg == "--paths") out.paths = split(value);
+            else if (arg == "--import")
+            {
+                out.import_module = (std::string_view{ value } == "yes");
+            }
+            else
+            {
+                std::fprintf(stderr, "unknown option %s\n", argv[i]);
+                std::exit(1);
+            }
+        }
+
+        // Идентификатор компилятора, указанного вручную, -- по имени
+        if (out.compiler_id.empty())
+        {
+            const std::string name = std::filesystem::path{ out.cxx }.filename().string();
+            if (name.find("clang") != std::string::npos) out.compiler_id = "Clang";
+            else if (name.find("g++") != std::string::npos ||
+                name.find("gcc") != std::string::npos)
+            {
+                out.compiler_id = "GNU";
+            }
+        }
+        return out;
+    }
+
+    std::string json_string(std::string_view text)
+    {
+        std::string out = "\"";
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    const options opts = parse_options(argc, argv);
+    const bool is_clang = opts.compiler_id.find("Clang") != std::string::npos;
+    const bool is_gcc = (opts.compiler_id == "GNU");
+    const char* instantiations_method = is_clang ? "time-trace"
+        : is_gcc ? "tree-original" : "unavailable";
+
+    std::filesystem::create_directories(opts.work);
+
+    // Без плейсхолдеров -- стоимость одного лишь разбора заголовков
+    std::vector<bench_case> cases{ { 0, 0, "int", "include" } };
+    for (const std::string& path : opts.paths)
+    {
+        for (const std::string& mix : opts.mixes)
+        {
+            for (const size_t length : opts.lengths)
+            {
+                for (const size_t count : opts.counts)
+                {
+                    cases.push_back({ count, length, mix, path });
+                }
+            }
+        }
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"compiler\": " << json_string(opts.cxx)
+        << ",\n  \"compiler_id\": " << json_string(opts.compiler_id)
+        << ",\n  \"import\": " << (opts.import_module ? "true" : "false")
+        << ",\n  \"instantiations_method\": " << json_string(instantiations_method)
+        << ",\n  \"flags\": [";
+    for (size_t i = 0; i < opts.flags.size(); ++i)
+    {
+        json << (i ? ", " : "") << json_string(opts.flags[i]);
+    }
+    json << "],\n  \"cases\": [";
+
+    std::fprintf(stderr, "%-10s %-7s %6s %7s %9s %9s %10s %9s %s\n", "path",
+        "mix", "count", "length", "wall_s", "cpu_s", "rss_kb", "obj_b",
+        "instantiations");
+
+    for (size_t i = 0; i < cases.size(); ++i)
+    {
+        const bench_case& c = cases[i];
+        const std::string name = c.path + "_" + c.mix + "_" +
+            std::to_string(c.n_placeholders) + "_" +
+            std::to_string(c.source_length);
+
+        const std::filesystem::path source = opts.work / (name + ".cpp");
+        const std::filesystem::path object = opts.work / (name + ".o");
+        const std::filesystem::path trace = opts.work / (name + ".json");
+        const std::filesystem::path log = opts.work / (name + ".log");
+        const std::filesystem::path dump = opts.work / (name + ".original");
+
+        std::ofstream{ source } << generate(c, opts.import_module);
+        std::filesystem::remove(trace);
+
+        std::vector<std::string> args{ opts.cxx };
+        args.insert(args.end(), opts.flags.begin(), opts.flags.end());
+        if (is_clang)
+        {
+            args.push_back("-ftime-trace");
+            args.push_back("-ftime-trace-granularity=0");
+        }
+        args.insert(args.end(), { "-I", opts.include, "-c", source.string(),
+            "-o", object.string() });
+
+        const run_result result = run(args, log);
+        const long object_size = result.ok
+            ? static_cast<long>(std::filesystem::file_size(object))
+            : -1;
+
+        // Для GCC -- отдельный проход, чтобы дамп не искажал замер
+        long instantiations = -1;
+        if (is_clang) instantiations = count_instantiations(trace);
+        else if (is_gcc && result.ok)
+        {
+            std::vector<std::string> dump_args{ opts.cxx };
+            dump_args.insert(dump_args.end(), opts.flags.begin(), opts.flags.end());
+            dump_args.insert(dump_args.end(), { "-fsyntax-only",
+                "-fdump-tree-original=" + dump.string(), "-I", opts.include,
+                source.string() });
+
+            if (run(dump_args, opts.work / (name + ".dump.log")).ok)
+            {
+                instantiations = count_dumped_instantiations(dump);
+            }
+            std::filesystem::remove(dump);
+        }
+
+        std::fprintf(stderr, "%-10s %-7s %6zu %7zu %9.3f %9.3f %10ld %9ld %ld%s\n",
+            c.path.c_str(), c.mix.c_str(), c.n_placeholders, c.source_length,
+            result.wall_s, result.cpu_s, result.max_rss_kb, object_size,
+            instantiations, result.ok ? "" : "  FAILED (see log)");
+
+        json << (i ? "," : "") << "\n    { \"path\": " << json_string(c.path)
+            << ", \"mix\": " << json_string(c.mix)
+            << ", \"placeholders\": " << c.n_placeholders
+            << ", \"source_length\": " << c.source_length
+            << ", \"ok\": " << (result.ok ? "true" : "false")
+            << ", \"wall_s\": " << result.wall_s
+            << ", \"cpu_s\": " << result.cpu_s
+            << ", \"peak_rss_kb\": " << result.max_rss_kb
+            << ", \"object_bytes\": " << object_size
+            << ", \"instantiations\": ";
+        if (instantiations >= 0) json << instantiations;
+        else json << "null";
+        json << " }";
+    }
+    json << "\n  ]\n}\n";
+
+    if (opts.out.empty()) std::fputs(json.str().c_str(), stdout);
+    else std::ofstream{ opts.out } << json.str();
+}
@@ -0,0 +1,819 @@
+#include "scan.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* Замеры пропускной способности сканирования во время исполнения.
+Для каждой нагрузки сравниваются:
+    scan          -- stdx::scan<format, Ts...>(std::string_view);
+    compiled      -- compiled_format::scan по той же строке формата;
+    batch         -- scan_batch: все записи нагрузки в столбцы значений,
+                     память столбцов используется повторно, как и арена;
+    sscanf        -- эквивалентная строка формата sscanf;
+    from_chars    -- поиск разделителей string_view::find и std::from_chars;
+    hand-tuned    -- разбор, написанный вручную под конкретную нагрузку.
+Все участники считают контрольную сумму значений, и расхождение с
+эталоном (scan) отмечается в отчёте.
+
+Запуск: scan_bench [--seed N] [--cpu N] [--scale N] [--repeats N] [--csv] */
+
+using namespace std::string_view_literals;
+
+namespace
+{
+    using namespace stdx;
+
+    struct options
+    {
+        uint64_t seed = 42;
+        int cpu = 0;
+        size_t scale = 1;
+        int repeats = 5;
+        bool csv = false;
+    };
+
+    // Сгенерированные записи, разделённые '\n'
+    struct workload
+    {
+        const char* name;
+        std::string data;
+        std::vector<std::string_view> lines;
+        size_t n_fields;
+    };
+
+    void split_lines(workload& w)
+    {
+        std::string_view rest = w.data;
+        while (!rest.empty())
+        {
+            const size_t end = rest.find('\n');
+            w.lines.push_back(rest.substr(0, end));
+            rest.remove_prefix((end == std::string_view::npos) ? rest.size() : end + 1);
+        }
+    }
+
+    //=== Контрольная сумма ===
+    template <typename T>
+    uint64_t checksum_of(const T& value)
+    {
+        if constexpr (std::is_same_v<T, std::string_view>)
+        {
+            return value.size() * 131 + (value.empty() ? 0 : value.front());
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            return std::bit_cast<uint64_t>(value);
+        }
+        else if constexpr (std::is_same_v<T, float>)
+        {
+            return std::bit_cast<uint32_t>(value);
+        }
+        else return static_cast<uint64_t>(value);
+    }
+
+    template <typename... Ts>
+    uint64_t checksum_of_tuple(const std::tuple<Ts...>& values)
+    {
+        return std::apply([](const Ts&... v)
+            {
+                uint64_t out = 0;
+                (..., (out = out * 31 + checksum_of(v)));
+                return out;
+            }, values);
+    }
+
+    //=== Замеры ===
+    struct measurement
+    {
+        double seconds;
+        uint64_t checksum;
+        size_t failures;
+    };
+
+    /* Лучшее из repeats прогонов по всем записям нагрузки.
+    parse_line возвращает контрольную сумму записи либо false */
+    template <typename ParseLine>
+    measurement measure(const workload& w, const options& opts,
+        ParseLine&& parse_line)
+    {
+        measurement out{ 1e300, 0, 0 };
+        for (int r = 0; r < opts.repeats; ++r)
+        {
+            uint64_t checksum = 0;
+            size_t failures = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (const std::string_view line : w.lines)
+            {
+                uint64_t line_checksum = 0;
+                if (parse_line(line, line_checksum)) checksum += line_checksum;
+                else ++failures;
+            }
+            const auto stop = std::chrono::steady_clock::now();
+
+            const double seconds =
+                std::chrono::duration<double>(stop - start).count();
+            out.seconds = std::min(out.seconds, seconds);
+            out.checksum = checksum;
+            out.failures = failures;
+        }
+        return out;
+    }
+
+    /* То же для пакетного сканирования: parse_all разбирает все
+    записи за раз и возвращает контрольную сумму и число отказов */
+    template <typename ParseAll>
+    measurement measure_batch(const options& opts, ParseAll&& parse_all)
+    {
+        measurement out{ 1e300, 0, 0 };
+        for (int r = 0; r < opts.repeats; ++r)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const auto [checksum, failures] = parse_all();
+            const auto stop = std::chrono::steady_clock::now();
+
+            const double seconds =
+                std::chrono::duration<double>(stop - start).count();
+            out.seconds = std::min(out.seconds, seconds);
+            out.checksum = checksum;
+            out.failures = failures;
+        }
+        return out;
+    }
+
+    void report_header(const options& opts)
+    {
+        if (opts.csv)
+        {
+            std::printf("workload,parser,bytes_per_s,records_per_s,"
+                "ns_per_field,failures,checksum_ok\n");
+        }
+        else
+        {
+            std::printf("%-10s %-12s %12s %12s %10s %9s %s\n", "workload",
+                "parser", "MB/s", "Mrec/s", "ns/field", "failures", "checksum");
+        }
+    }
+
+    void report(const workload& w, const char* parser, const measurement& m,
+        uint64_t reference, const options& opts)
+    {
+        const double bytes_per_s = w.data.size() / m.seconds;
+        const double records_per_s = w.lines.size() / m.seconds;
+        const double ns_per_field =
+            m.seconds * 1e9 / (w.lines.size() * w.n_fields);
+        const char* status = (m.checksum == reference) ? "ok" : "MISMATCH";
+
+        if (opts.csv)
+        {
+            std::printf("%s,%s,%.0f,%.0f,%.3f,%zu,%d\n", w.name, parser,
+                bytes_per_s, records_per_s, ns_per_field, m.failures,
+                m.checksum == reference);
+        }
+        else
+        {
+            std::printf("%-10s %-12s %12.1f %12.2f %10.2f %9zu %s\n", w.name,
+                parser, bytes_per_s / 1e6, records_per_s / 1e6, ns_per_field,
+                m.failures, status);
+        }
+    }
+
+    //=== Общие участники ===
+    /* Разбор через std::from_chars: строка формата один раз разбивается
+    на разделители, затем каждая запись разбирается поиском разделителей
+    string_view::find; вид значения определяется типом */
+    struct from_chars_parser
+    {
+        size_t prefix = 0;
+        std::vector<std::string_view> separators;
+
+        explicit from_chars_parser(std::string_view format)
+        {
+            size_t pos = format.find('{');
+            prefix = pos;
+            while (pos != std::string_view::npos)
+            {
+                const size_t close = format.find('}', pos);
+                const size_t next = format.find('{', close);
+                separators.push_back(format.substr(close + 1,
+                    (next == std::string_view::npos ? format.size() : next) -
+                    (close + 1)));
+                pos = next;
+            }
+        }
+
+        template <typename... Ts>
+        bool parse(std::string_view line, std::tuple<Ts...>& out) const
+        {
+            size_t pos = prefix;
+            return [&]<size_t... I>(std::index_sequence<I...>)
+                {
+                    return (... && parse_field(line, pos, separators[I],
+                        std::get<I>(out)));
+                }(std::index_sequence_for<Ts...>{});
+        }
+
+        template <typename T>
+        static bool parse_field(std::string_view line, size_t& pos,
+            std::string_view sep, T& out)
+        {
+            const size_t end = sep.empty() ? line.size() : line.find(sep, pos);
+            if (end == std::string_view::npos) return false;
+
+            const std::string_view field = line.substr(pos, end - pos);
+            pos = end + sep.size();
+
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                out = (field.size() > 1 && field.front() == '"')
+                    ? field.substr(1, field.size() - 2)
+                    : field;
+                return true;
+            }
+            else
+            {
+                const char* first = field.data() +
+                    (!field.empty() && field.front() == '+');
+                const auto [ptr, ec] =
+                    std::from_chars(first, field.data() + field.size(), out);
+                return ec == std::errc{} && ptr == field.data() + field.size();
+            }
+        }
+    };
+
+    //=== Ручные ядра для hand-tuned ===
+    // Беззнаковое число до символа-терминатора
+    template <typename UInt>
+    inline bool take_uint(const char*& pos, const char* end, char stop, UInt& out)
+    {
+        UInt value = 0;
+        const char* start = pos;
+        while (pos != end && *pos != stop)
+        {
+            const unsigned digit = static_cast<unsigned char>(*pos - '0');
+            if (digit > 9) return false;
+            value = value * 10 + digit;
+            ++pos;
+        }
+        out = value;
+        return pos != start;
+    }
+
+    template <typename Int>
+    inline bool take_int(const char*& pos, const char* end, char stop, Int& out)
+    {
+        const bool is_negative = (pos != end && *pos == '-');
+        pos += is_negative;
+
+        std::make_unsigned_t<Int> value;
+        if (!take_uint(pos, end, stop, value)) return false;
+        out = static_cast<Int>(is_negative ? 0 - value : value);
+        return true;
+    }
+
+    inline bool take_double(const char*& pos, const char* end, char stop,
+        double& out)
+    {
+        const char* field_end = static_cast<const char*>(
+            std::memchr(pos, stop, end - pos));
+        if (!field_end) field_end = end;
+
+        const auto [ptr, ec] = std::from_chars(pos, field_end, out);
+        pos = ptr;
+        return ec == std::errc{} && ptr == field_end;
+    }
+
+    inline bool take_string(const char*& pos, const char* end, char stop,
+        std::string_view& out)
+    {
+        const char* field_end = static_cast<const char*>(
+            std::memchr(pos, stop, end - pos));
+        if (!field_end) field_end = end;
+
+        out = { pos, static_cast<size_t>(field_end - pos) };
+        pos = field_end;
+        return true;
+    }
+
+    // Пропуск известного текста без проверки
+    inline void skip(const char*& pos, size_t n) { pos += n; }
+
+    //=== Генерация данных ===
+    std::string random_word(std::mt19937_64& rng, size_t min_size, size_t max_size)
+    {
+        std::uniform_int_distribution<size_t> size{ min_size, max_size };
+        std::uniform_int_distribution<int> letter{ 'a', 'z' };
+
+        std::string out(size(rng), ' ');
+        for (char& c : out) c = static_cast<char>(letter(rng));
+        return out;
+    }
+
+    std::string random_double(std::mt19937_64& rng)
+    {
+        std::uniform_real_distribution<double> value{ -1e4, 1e4 };
+        std::uniform_int_distribution<int> precision{ 1, 9 };
+
+        char buffer[64];
+        const int n = std::snprintf(buffer, sizeof(buffer), "%.*f",
+            precision(rng), value(rng));
+        return { buffer, static_cast<size_t>(n) };
+    }
+
+    //=== Нагрузка 1: короткие строки key=value ===
+    constexpr format_string<"user={%s} id={%d} shard={%u} ok={%d}"> kv_format;
+    using kv_values = std::tuple<std::string_view, int, unsigned, int>;
+
+    workload make_kv(std::mt19937_64& rng, size_t n)
+    {
+        workload w{ "kv", {}, {}, 4 };
+        std::uniform_int_distribution<int> id;
+        std::uniform_int_distribution<unsigned> shard{ 0, 1023 };
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            w.data += "user=" + random_word(rng, 4, 12) +
+                " id=" + std::to_string(id(rng)) +
+                " shard=" + std::to_string(shard(rng)) +
+                " ok=" + std::to_string(shard(rng) & 1) + "\n";
+        }
+        split_lines(w);
+        return w;
+    }
+
+    bool kv_hand_tuned(std::string_view line, kv_values& out)
+    {
+        const char* pos = line.data();
+        const char* end = pos + line.size();
+
+        skip(pos, "user="sv.size());
+        take_string(pos, end, ' ', std::get<0>(out));
+        skip(pos, " id="sv.size());
+        if (!take_int(pos, end, ' ', std::get<1>(out))) return false;
+        skip(pos, " shard="sv.size());
+        if (!take_uint(pos, end, ' ', std::get<2>(out))) return false;
+        skip(pos, " ok="sv.size());
+        return take_int(pos, end, '\0', std::get<3>(out));
+    }
+
+    bool kv_sscanf(std::string_view line, kv_values& out)
+    {
+        // sscanf требует ноль-терминатора
+        char buffer[256];
+        char user[64];
+        const size_t n = std::min(line.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, line.data(), n);
+        buffer[n] = '\0';
+
+        int id, ok;
+        unsigned shard;
+        if (std::sscanf(buffer, "user=%63s id=%d shard=%u ok=%d",
+            user, &id, &shard, &ok) != 4) return false;
+
+        // Представление указывает в исходную строку, как и у прочих участников
+        out = { line.substr(5, std::strlen(user)), id, shard, ok };
+        return true;
+    }
+
+    //=== Нагрузка 2: CSV-подобные записи из 40 полей ===
+    constexpr size_t CSV_FIELDS = 40;
+
+    // "{%d},{%f},{%s},{%u},..." -- 40 плейсхолдеров через запятую
+    constexpr auto csv_text =
+        []()
+        {
+            constexpr char specs[] = { 'd', 'f', 's', 'u' };
+            constexpr size_t size = CSV_FIELDS * 4 + CSV_FIELDS - 1;
+
+            char buffer[size + 1]{};
+            size_t pos = 0;
+            for (size_t i = 0; i < CSV_FIELDS; ++i)
+            {
+                if (i) buffer[pos++] = ',';
+                buffer[pos++] = '{';
+                buffer[pos++] = '%';
+                buffer[pos++] = specs[i % 4];
+                buffer[pos++] = '}';
+            }
+            return fixed_string<size + 1>{ buffer, buffer + size };
+        }();
+    constexpr format_string<csv_text> csv_format;
+
+    template <size_t I>
+    using csv_type = std::tuple_element_t<I % 4,
+        std::tuple<int64_t, double, std::string_view, uint32_t>>;
+
+    using csv_values = decltype([]<size_t... I>(std::index_sequence<I...>)
+        {
+            return std::tuple<csv_type<I>...>{};
+        }(std::make_index_sequence<CSV_FIELDS>{}));
+
+    workload make_csv(std::mt19937_64& rng, size_t n)
+    {
+        workload w{ "csv40", {}, {}, CSV_FIELDS };
+        std::uniform_int_distribution<int64_t> int_value{ -1'000'000'000'000,
+            1'000'000'000'000 };
+        std::uniform_int_distribution<uint32_t> uint_value;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t f = 0; f < CSV_FIELDS; ++f)
+            {
+                if (f) w.data += ',';
+                switch (f % 4)
+                {
+                case 0: w.data += std::to_string(int_value(rng)); break;
+                case 1: w.data += random_double(rng); break;
+                case 2: w.data += random_word(rng, 1, 16); break;
+                case 3: w.data += std::to_string(uint_value(rng)); break;
+                }
+            }
+            w.data += '\n';
+        }
+        split_lines(w);
+        return w;
+    }
+
+    bool csv_hand_tuned(std::string_view line, csv_values& out)
+    {
+        const char* pos = line.data();
+        const char* end = pos + line.size();
+
+        return [&]<size_t... I>(std::index_sequence<I...>)
+            {
+                return (... && [&]()
+                    {
+                        if constexpr (I) skip(pos, 1);
+                        constexpr char stop = (I + 1 < CSV_FIELDS) ? ',' : '\0';
+                        auto& value = std::get<I>(out);
+
+                        if constexpr (I % 4 == 0) return take_int(pos, end, stop, value);
+                        else if constexpr (I % 4 == 1) return take_double(pos, end, stop, value);
+                        else if constexpr (I % 4 == 2) return take_string(pos, end, stop, value);
+                        else return take_uint(pos, end, stop, value);
+                    }());
+            }(std::make_index_sequence<CSV_FIELDS>{});
+    }
+
+    bool csv_sscanf(std::string_view line, csv_values& out)
+    {
+        static const std::string format =
+            []()
+            {
+                constexpr const char* specs[] = { "%ld", "%lf", "%63[^,]", "%u" };
+                std::string out;
+                for (size_t i = 0; i < CSV_FIELDS; ++i)
+                {
+                    if (i) out += ',';
+                    out += specs[i % 4];
+                }
+                return out;
+            }();
+
+        char buffer[4096];
+        const size_t n = std::min(line.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, line.data(), n);
+        buffer[n] = '\0';
+
+        /* Строки sscanf копирует в собственные буферы; они должны
+        пережить вызов, чтобы по ним можно было посчитать сумму */
+        static char strings[CSV_FIELDS / 4][64];
+        long ints[CSV_FIELDS / 4];
+
+        const auto targets = [&]<size_t... I>(std::index_sequence<I...>)
+            {
+                return std::tuple{ [&]() -> void*
+                    {
+                        if constexpr (I % 4 == 0) return &ints[I / 4];
+                        else if constexpr (I % 4 == 1) return &std::get<I>(out);
+                        else if constexpr (I % 4 == 2) return strings[I / 4];
+                        else return &std::get<I>(out);
+                    }()... };
+            }(std::make_index_sequence<CSV_FIELDS>{});
+
+        const int scanned = std::apply([&](auto... ptrs)
+            {
+                return std::sscanf(buffer, format.c_str(), ptrs...);
+            }, targets);
+        if (scanned != static_cast<int>(CSV_FIELDS)) return false;
+
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (..., [&]()
+                {
+                    if constexpr (I % 4 == 0) std::get<I>(out) = ints[I / 4];
+                    else if constexpr (I % 4 == 2)
+                    {
+                        std::get<I>(out) = std::string_view{ strings[I / 4] };
+                    }
+                }());
+        }(std::make_index_sequence<CSV_FIELDS>{});
+        return true;
+    }
+
+    //=== Нагрузка 3: метрики с плавающей точкой ===
+    constexpr format_string<"host={%s} cpu={%f} mem={%f} load1={%f} "
+        "load5={%f} load15={%f} temp={%f} io={%f}"> metrics_format;
+    using metrics_values = std::tuple<std::string_view,
+        double, double, double, double, double, double, double>;
+
+    workload make_metrics(std::mt19937_64& rng, size_t n)
+    {
+        workload w{ "metrics", {}, {}, 8 };
+        constexpr const char* keys[] = { " cpu=", " mem=", " load1=",
+            " load5=", " load15=", " temp=", " io=" };
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            w.data += "host=" + random_word(rng, 6, 14);
+            for (const char* key : keys) w.data += key + random_double(rng);
+            w.data += '\n';
+        }
+        split_lines(w);
+        return w;
+    }
+
+    bool metrics_hand_tuned(std::string_view line, metrics_values& out)
+    {
+        const char* pos = line.data();
+        const char* end = pos + line.size();
+
+        skip(pos, "host="sv.size());
+        take_string(pos, end, ' ', std::get<0>(out));
+
+        return [&]<size_t... I>(std::index_sequence<I...>)
+            {
+                // Пропускаем ' ' и ключ до '='
+                return (... && [&]()
+                    {
+                        pos = static_cast<const char*>(
+                            std::memchr(pos, '=', end - pos)) + 1;
+                        return take_double(pos, end, ' ', std::get<I + 1>(out));
+                    }());
+            }(std::make_index_sequence<7>{});
+    }
+
+    bool metrics_sscanf(std::string_view line, metrics_values& out)
+    {
+        char buffer[512];
+        char host[64];
+        const size_t n = std::min(line.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, line.data(), n);
+        buffer[n] = '\0';
+
+        auto& [h, cpu, mem, load1, load5, load15, temp, io] = out;
+        if (std::sscanf(buffer, "host=%63s cpu=%lf mem=%lf load1=%lf "
+            "load5=%lf load15=%lf temp=%lf io=%lf", host, &cpu, &mem,
+            &load1, &load5, &load15, &temp, &io) != 8) return false;
+
+        h = line.substr(5, std::strlen(host));
+        return true;
+    }
+
+    //=== Нагрузка 4: журнал с временными метками ===
+    constexpr format_string<"{%u}-{%u}-{%u}T{%u}:{%u}:{%f}Z "
+        "[{%s}] worker-{%u} {%q}"> log_format;
+    using log_values = std::tuple<unsigned, unsigned, unsigned, unsigned,
+        unsigned, double, std::string_view, unsigned, std::string_view>;
+
+    workload make_log(std::mt19937_64& rng, size_t n)
+    {
+        workload w{ "log", {}, {}, 9 };
+        constexpr const char* levels[] = { "INFO", "WARN", "ERROR", "DEBUG" };
+        std::uniform_int_distribution<unsigned> month{ 1, 12 }, day{ 1, 28 },
+            hour{ 0, 23 }, minute{ 0, 59 }, worker{ 0, 255 }, level{ 0, 3 },
+            millis{ 0, 59'999 }, words{ 3, 12 };
+
+        char buffer[128];
+        for (size_t i = 0; i < n; ++i)
+        {
+            const unsigned ms = millis(rng);
+            std::snprintf(buffer, sizeof(buffer),
+                "2024-%02u-%02uT%02u:%02u:%02u.%03uZ [%s] worker-%u \"",
+                month(rng), day(rng), hour(rng), minute(rng), ms / 1000,
+                ms % 1000, levels[level(rng)], worker(rng));
+            w.data += buffer;
+
+            for (unsigned k = words(rng); k; --k)
+            {
+                w.data += random_word(rng, 2, 9);
+                w.data += (k > 1) ? ", " : "";
+            }
+            w.data += "\"\n";
+        }
+        split_lines(w);
+        return w;
+    }
+
+    bool log_hand_tuned(std::string_view line, log_values& out)
+    {
+        const char* pos = line.data();
+        const char* end = pos + line.size();
+        auto& [year, month, day, hour, minute, second, level, worker, message] = out;
+
+        // Поля фиксированной ширины -- без поиска разделителей
+        const auto two_digits = [&](size_t at)
+            {
+                return static_cast<unsigned>((pos[at] - '0') * 10 + (pos[at + 1] - '0'));
+            };
+        year = static_cast<unsigned>(two_digits(0) * 100 + two_digits(2));
+        month = two_digits(5);
+        day = two_digits(8);
+        hour = two_digits(11);
+        minute = two_digits(14);
+        skip(pos, 17);
+
+        if (!take_double(pos, end, 'Z', second)) return false;
+        skip(pos, " ["sv.size() + 1);
+        take_string(pos, end, ']', level);
+        skip(pos, "] worker-"sv.size());
+        if (!take_uint(pos, end, ' ', worker)) return false;
+        skip(pos, " \""sv.size());
+
+        message = { pos, static_cast<size_t>(end - pos - 1) };
+        return end[-1] == '"';
+    }
+
+    bool log_sscanf(std::string_view line, log_values& out)
+    {
+        char buffer[512];
+        static char level[16];
+        static char message[256];
+        const size_t n = std::min(line.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, line.data(), n);
+        buffer[n] = '\0';
+
+        auto& [year, month, day, hour, minute, second, lv, worker, msg] = out;
+        if (std::sscanf(buffer, "%u-%u-%uT%u:%u:%lfZ [%15[^]]] worker-%u \"%255[^\"]\"",
+            &year, &month, &day, &hour, &minute, &second, level, &worker,
+            message) != 9) return false;
+
+        lv = { level, std::strlen(level) };
+        msg = { message, std::strlen(message) };
+        return true;
+    }
+
+    //=== Прогон одной нагрузки ===
+    template <format_string format, typename... Ts>
+    void run(const workload& w, const options& opts,
+        bool (*hand_tuned)(std::string_view, std::tuple<Ts...>&),
+        bool (*with_sscanf)(std::string_view, std::tuple<Ts...>&))
+    {
+        scan_arena arena;
+        const compiled_format compiled =
+            *compiled_format::compile(format.str.data);
+        const from_chars_parser manual{ format.str.data };
+
+        const measurement reference = measure(w, opts,
+            [&](std::string_view line, uint64_t& checksum)
+            {
+                const std::expected result = scan<format, Ts...>(line, &arena);
+                if (!result) return false;
+                checksum = checksum_of_tuple(result->values);
+                return true;
+            });
+        report(w, "scan", reference, reference.checksum, opts);
+
+        report(w, "compiled", measure(w, opts,
+            [&](std::string_view line, uint64_t& checksum)
+            {
+                const std::expected result =
+                    compiled.scan<Ts...>(line, &arena);
+                if (!result) return false;
+                checksum = checksum_of_tuple(result->values);
+                return true;
+            }), reference.checksum, opts);
+
+        column_batch<Ts...> batch;
+        report(w, "batch", measure_batch(opts,
+            [&]()
+            {
+                scan_batch<format, Ts...>(w.lines, batch, &arena);
+
+                uint64_t checksum = 0;
+                size_t failures = 0;
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    if (!batch.valid[i])
+                    {
+                        ++failures;
+                        continue;
+                    }
+                    checksum += [&]<size_t... I>(std::index_sequence<I...>)
+                        {
+                            return checksum_of_tuple(std::tuple<Ts...>{
+                                std::get<I>(batch.columns)[i]... });
+                        }(std::index_sequence_for<Ts...>{});
+                }
+                return std::pair{ checksum, failures };
+            }), reference.checksum, opts);
+
+        report(w, "sscanf", measure(w, opts,
+            [&](std::string_view line, uint64_t& checksum)
+            {
+                std::tuple<Ts...> values;
+                if (!with_sscanf(line, values)) return false;
+                checksum = checksum_of_tuple(values);
+                return true;
+            }), reference.checksum, opts);
+
+        report(w, "from_chars", measure(w, opts,
+            [&](std::string_view line, uint64_t& checksum)
+            {
+                std::tuple<Ts...> values;
+                if (!manual.parse(line, values)) return false;
+                checksum = checksum_of_tuple(values);
+                return true;
+            }), reference.checksum, opts);
+
+        report(w, "hand-tuned", measure(w, opts,
+            [&](std::string_view line, uint64_t& checksum)
+            {
+                std::tuple<Ts...> values;
+                if (!hand_tuned(line, values)) return false;
+                checksum = checksum_of_tuple(values);
+                return true;
+            }), reference.checksum, opts);
+    }
+
+    // Привязка потока к ядру для воспроизводимости замеров
+    void pin_thread(int cpu)
+    {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+        {
+            std::fprintf(stderr, "warning: failed to pin to CPU %d\n", cpu);
+        }
+#else
+        (void)cpu;
+#endif
+    }
+
+    options parse_options(int argc, char* argv[])
+    {
+        options out;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : "";
+
+            if (arg == "--csv") out.csv = true;
+            else if (arg == "--seed") out.seed = std::strtoull(value, nullptr, 10), ++i;
+            else if (arg == "--cpu") out.cpu = std::atoi(value), ++i;
+            else if (arg == "--scale") out.scale = std::strtoull(value, nullptr, 10), ++i;
+            else if (arg == "--repeats") out.repeats = std::atoi(value), ++i;
+            else
+            {
+                std::fprintf(stderr, "usage: scan_bench [--seed N] [--cpu N] "
+                    "[--scale N] [--repeats N] [--csv]\n");
+                std::exit(1);
+            }
+        }
+
+        out.scale = std::max<size_t>(out.scale, 1);
+        out.repeats = std::max(out.repeats, 1);
+        return out;
+    }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    const options opts = parse_options(argc, argv);
+    pin_thread(opts.cpu);
+
+    // Каждая нагрузка получает собственный генератор с фиксированным зерном
+    std::mt19937_64 kv_rng{ opts.seed };
+    std::mt19937_64 csv_rng{ opts.seed + 1 };
+    std::mt19937_64 metrics_rng{ opts.seed + 2 };
+    std::mt19937_64 log_rng{ opts.seed + 3 };
+
+    const workload kv = make_kv(kv_rng, 200'000 * opts.scale);
+    const workload csv = make_csv(csv_rng, 10'000 * opts.scale);
+    const workload metrics = make_metrics(metrics_rng, 100'000 * opts.scale);
+    const workload log = make_log(log_rng, 100'000 * opts.scale);
+
+    report_header(opts);
+    run<kv_format>(kv, opts, kv_hand_tuned, kv_sscanf);
+    run<csv_format>(csv, opts, csv_hand_tuned, csv_sscanf);
+    run<metrics_format>(metrics, opts, metrics_hand_tuned, metrics_sscanf);
+    run<log_format>(log, opts, log_hand_tuned, log_sscanf);
+}
@@ -0,0 +1,963 @@
+#include "scan.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Дифференциальная проверка ядер преобразования и замер их пропускной
+способности в одном прогоне.
+
+Каждый вход сверяется с эталоном на std::from_chars, повторяющим
+грамматику parse_value: ведущий '+', завершающие 'f' и 'e' у чисел с
+плавающей точкой.  Проверяются:
+    convert_integer для всех целочисленных типов -- SWAR-ядра char и
+        char16_t, поразрядное ядро char32_t;
+    convert_float для float и double, в том числе после сужения
+        широких кодовых единиц;
+    decimal_to_float -- ветвь этапа компиляции convert_float,
+        вычисленная во время исполнения;
+    convert_integer_column и convert_float_column -- векторные ядра
+        пакетного сканирования, значение в значение с convert_*;
+    convert_rows_sse41/avx2/avx512 -- строка в строку с convert_row_scalar.
+Словарь состязательных входов, кроме того, вычисляется на этапе
+компиляции (ветви if consteval тех же ядер и parse_value) и сверяется
+с вычислениями во время исполнения; числа с плавающей точкой --
+побитово.
+
+Сборка с -DSTDX_SCAN_LIBFUZZER даёт цель libFuzzer
+(LLVMFuzzerTestOneInput), иначе -- самостоятельный драйвер:
+
+    convert_fuzz [--seed N] [--iterations N] [--repeats N] [--csv] [файлы...]
+
+Файлы -- входы для повторной проверки (например, найденные libFuzzer).
+Код возврата ненулевой при любом расхождении */
+
+using namespace std::string_view_literals;
+
+namespace
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+
+    //=== Расхождения ===
+    size_t n_mismatches = 0;
+
+    std::string escape(std::string_view input)
+    {
+        std::string out;
+        for (const char c : input)
+        {
+            const unsigned char u = static_cast<unsigned char>(c);
+            if (u >= 0x20 && u < 0x7f && c != '\\' && c != '"') out += c;
+            else
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\x%02x", u);
+                out += buffer;
+            }
+        }
+        return out;
+    }
+
+    void report_mismatch(const char* kernel, std::string_view input,
+        const std::string& expected, const std::string& actual)
+    {
+        if (++n_mismatches <= 40)
+        {
+            std::fprintf(stderr, "MISMATCH %s \"%s\": expected %s, got %s\n",
+                kernel, escape(input).c_str(), expected.c_str(), actual.c_str());
+        }
+#ifdef STDX_SCAN_LIBFUZZER
+        std::abort();
+#endif
+    }
+
+    template <typename T>
+    std::string describe(const std::errc ec, const T& value)
+    {
+        if (ec == std::errc::invalid_argument) return "invalid_argument";
+        if (ec == std::errc::result_out_of_range) return "result_out_of_range";
+        if (ec != std::errc{}) return "errc " + std::to_string(int(ec));
+
+        std::ostringstream out;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            out.precision(17);
+            out << value;
+        }
+        else out << +value;
+        return out.str();
+    }
+
+    // Значения с плавающей точкой совпадают побитово; NaN -- с любым NaN
+    template <typename T>
+    bool same_value(const T& a, const T& b)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return (std::isnan(a) && std::isnan(b)) ||
+                std::bit_cast<std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>(a) ==
+                std::bit_cast<std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>(b);
+        }
+        else return a == b;
+    }
+
+    template <typename T>
+    void expect(const char* kernel, std::string_view input,
+        const std::errc expected_ec, const T& expected,
+        const std::errc actual_ec, const T& actual)
+    {
+        if (expected_ec != actual_ec ||
+            (expected_ec == std::errc{} && !same_value(expected, actual)))
+        {
+            report_mismatch(kernel, input, describe(expected_ec, expected),
+                describe(actual_ec, actual));
+        }
+    }
+
+    //=== Эталон на std::from_chars ===
+    /* Целое: необязательный знак, затем только цифры.  Беззнаковым
+    типам допустим лишь отрицательный ноль */
+    template <typename Int>
+    std::errc reference_integer(std::string_view field, Int& out)
+    {
+        bool is_negative = false;
+        if (!field.empty() && (field.front() == '-' || field.front() == '+'))
+        {
+            is_negative = (field.front() == '-');
+            field.remove_prefix(1);
+        }
+
+        if (field.empty() || !std::all_of(field.begin(), field.end(),
+            [](const char c) { return c >= '0' && c <= '9'; }))
+        {
+            return std::errc::invalid_argument;
+        }
+
+        if constexpr (std::is_unsigned_v<Int>)
+        {
+            if (is_negative)
+            {
+                if (field.find_first_not_of('0') != std::string_view::npos)
+                {
+                    return std::errc::result_out_of_range;
+                }
+                out = 0;
+                return std::errc{};
+            }
+            return std::from_chars(field.data(), field.data() + field.size(), out).ec;
+        }
+        else
+        {
+            const std::string signed_field =
+                (is_negative ? "-" : "") + std::string{ field };
+            return std::from_chars(signed_field.data(),
+                signed_field.data() + signed_field.size(), out).ec;
+        }
+    }
+
+    /* Число с плавающей точкой: завершающие 'f' и 'e' после цифры или
+    точки отбрасываются, ведущий '+' допустим, но не перед '-' */
+    template <typename Float>
+    std::errc reference_float(std::string_view field, Float& out)
+    {
+        for (const char suffix : { 'f', 'e' })
+        {
+            if (field.size() > 1 && (field.back() | 0x20) == suffix &&
+                (field[field.size() - 2] == '.' ||
+                    (field[field.size() - 2] >= '0' && field[field.size() - 2] <= '9')))
+            {
+                field.remove_suffix(1);
+            }
+        }
+
+        if (!field.empty() && field.front() == '+')
+        {
+            field.remove_prefix(1);
+            if (!field.empty() && field.front() == '-') return std::errc::invalid_argument;
+        }
+        if (field.empty()) return std::errc::invalid_argument;
+
+        // Хвост после числа важнее выхода за диапазон
+        const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+        return (ptr == field.data() + field.size()) ? ec : std::errc::invalid_argument;
+    }
+
+    // Кодовые единицы входа -- байты без знака
+    template <typename CharT>
+    std::basic_string<CharT> widen(std::string_view input)
+    {
+        std::basic_string<CharT> out;
+        for (const char c : input) out += static_cast<CharT>(static_cast<unsigned char>(c));
+        return out;
+    }
+
+    //=== Проверка одного входа ===
+    template <typename Int>
+    void check_integer(std::string_view input)
+    {
+        Int expected{}, actual{};
+        const std::errc expected_ec = reference_integer(input, expected);
+        expect("convert_integer<char>", input, expected_ec, expected,
+            convert_integer(input, actual), actual);
+
+        const std::u16string u16 = widen<char16_t>(input);
+        expect("convert_integer<char16_t>", input, expected_ec, expected,
+            convert_integer(std::u16string_view{ u16 }, actual), actual);
+
+        const std::u32string u32 = widen<char32_t>(input);
+        expect("convert_integer<char32_t>", input, expected_ec, expected,
+            convert_integer(std::u32string_view{ u32 }, actual), actual);
+    }
+
+    template <typename Float>
+    void check_float(std::string_view input)
+    {
+        Float expected{}, actual{};
+        const std::errc expected_ec = reference_float(input, expected);
+        expect("convert_float<char>", input, expected_ec, expected,
+            convert_float(input, actual), actual);
+
+        // Ветвь этапа компиляции convert_float, вычисленная во время исполнения
+        std::string_view stripped = input;
+        const std::errc exact_ec = strip_float_affixes(stripped)
+            ? decimal_to_float(stripped, actual)
+            : std::errc::invalid_argument;
+        expect(sizeof(Float) == 4 ? "decimal_to_float<float>" : "decimal_to_float<double>",
+            input, expected_ec, expected, exact_ec, actual);
+
+        // Широкое поле длиннее буфера сужения отвергается целиком
+        const bool too_long = input.size() > max_wide_float_size;
+        const std::u16string u16 = widen<char16_t>(input);
+        expect("convert_float<char16_t>", input,
+            too_long ? std::errc::invalid_argument : expected_ec, expected,
+            convert_float(std::u16string_view{ u16 }, actual), actual);
+    }
+
+    /* Цифра соседней плоскости (c + 0x100, c + 0x10000) -- не цифра:
+    SWAR-ядро широких единиц не должно принять её по младшему байту */
+    template <typename CharT>
+    void check_wide_digit(std::string_view input, const size_t at, const char32_t plane)
+    {
+        std::basic_string<CharT> wide = widen<CharT>(input);
+        wide[at] = static_cast<CharT>(wide[at] + plane);
+
+        int64_t value = 0;
+        const std::errc ec = convert_integer(std::basic_string_view<CharT>{ wide }, value);
+        if (ec != std::errc::invalid_argument)
+        {
+            report_mismatch(sizeof(CharT) == 2 ? "convert_integer<char16_t> plane"
+                : "convert_integer<char32_t> plane", input,
+                "invalid_argument", describe(ec, value));
+        }
+    }
+
+    void check_all(std::string_view input)
+    {
+        check_integer<int8_t>(input);
+        check_integer<uint8_t>(input);
+        check_integer<int16_t>(input);
+        check_integer<uint16_t>(input);
+        check_integer<int32_t>(input);
+        check_integer<uint32_t>(input);
+        check_integer<int64_t>(input);
+        check_integer<uint64_t>(input);
+        check_float<float>(input);
+        check_float<double>(input);
+
+        for (size_t at = 0; at < input.size(); ++at)
+        {
+            if (input[at] < '0' || input[at] > '9') continue;
+            check_wide_digit<char16_t>(input, at, 0x100);
+            check_wide_digit<char32_t>(input, at, 0x10000);
+        }
+    }
+
+    //=== Векторные ядра пакетного сканирования ===
+    /* Поля помещаются внутрь записей со случайным окружением: ядра
+    читают по 16 байт в пределах записи, а не поля */
+    template <typename T>
+    void check_column(const std::vector<std::string>& inputs, std::mt19937_64& rng)
+    {
+        column_workspace ws;
+        std::vector<T> out(BATCH_BLOCK_SIZE);
+        std::vector<uint8_t> valid(BATCH_BLOCK_SIZE);
+
+        for (size_t first = 0; first < inputs.size(); first += BATCH_BLOCK_SIZE)
+        {
+            const size_t n = std::min(BATCH_BLOCK_SIZE, inputs.size() - first);
+
+            std::vector<std::string> storage;
+            std::vector<std::string_view> records(n);
+            std::vector<std::string_view> spans(n);
+            std::vector<size_t> offsets(n);
+            storage.reserve(n);
+            for (size_t r = 0; r < n; ++r)
+            {
+                const size_t before = rng() % 20;
+                const size_t after = rng() % 20;
+                storage.push_back(std::string(before, ';') + inputs[first + r] +
+                    std::string(after, '7'));
+                offsets[r] = before;
+            }
+            for (size_t r = 0; r < n; ++r)
+            {
+                records[r] = storage[r];
+                spans[r] = records[r].substr(offsets[r], inputs[first + r].size());
+            }
+
+            std::fill(valid.begin(), valid.end(), 1);
+            if constexpr (std::is_integral_v<T>)
+            {
+                convert_integer_column(spans.data(), records.data(), n,
+                    out.data(), valid.data(), ws);
+            }
+            else
+            {
+                convert_float_column(spans.data(), records.data(), n,
+                    out.data(), valid.data(), ws);
+            }
+
+            for (size_t r = 0; r < n; ++r)
+            {
+                T expected{};
+                std::errc ec;
+                if constexpr (std::is_integral_v<T>) ec = convert_integer(spans[r], expected);
+                else ec = convert_float(spans[r], expected);
+
+                const std::errc actual_ec = valid[r] ? std::errc{} : ec == std::errc{}
+                    ? std::errc::invalid_argument : ec;
+                expect(std::is_integral_v<T> ? "convert_integer_column"
+                    : "convert_float_column", spans[r], ec, expected,
+                    actual_ec, out[r]);
+            }
+        }
+    }
+
+    // Строки цифр: rows.size() кратен DIGIT_ROW_SIZE
+    void check_rows(const std::vector<char>& rows)
+    {
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+        const size_t n = rows.size() / DIGIT_ROW_SIZE;
+
+        std::vector<uint64_t> expected(n);
+        std::vector<uint8_t> expected_ok(n);
+        for (size_t r = 0; r < n; ++r)
+        {
+            expected_ok[r] = convert_row_scalar(rows.data() + r * DIGIT_ROW_SIZE, expected[r]);
+        }
+
+        const auto check = [&](const char* kernel, auto&& convert)
+            {
+                std::vector<uint64_t> out(n);
+                std::vector<uint8_t> ok(n);
+                convert(rows.data(), n, out.data(), ok.data());
+
+                for (size_t r = 0; r < n; ++r)
+                {
+                    if (ok[r] != expected_ok[r] || (ok[r] && out[r] != expected[r]))
+                    {
+                        report_mismatch(kernel,
+                            { rows.data() + r * DIGIT_ROW_SIZE, DIGIT_ROW_SIZE },
+                            describe(expected_ok[r] ? std::errc{} : std::errc::invalid_argument,
+                                expected[r]),
+                            describe(ok[r] ? std::errc{} : std::errc::invalid_argument, out[r]));
+                    }
+                }
+            };
+
+        const digit_kernel best = get_digit_kernel();
+        if (best >= digit_kernel::sse41) check("convert_rows_sse41", convert_rows_sse41);
+        if (best >= digit_kernel::avx2) check("convert_rows_avx2", convert_rows_avx2);
+        if (best >= digit_kernel::avx512) check("convert_rows_avx512", convert_rows_avx512);
+#else
+        (void)rows;
+#endif
+    }
+
+    //=== Словарь: этап компиляции против времени исполнения ===
+    constexpr std::string_view DICTIONARY[] = {
+        ""sv, "+"sv, "-"sv, "+-1"sv, "-+1"sv, "--1"sv, "0"sv, "-0"sv, "+0"sv,
+        "00000000"sv, "000000000000000000000000001"sv, "1234567"sv, "12345678"sv,
+        "123456789"sv, "1234567/"sv, "1234567:"sv, "/2345678"sv, ":2345678"sv,
+        "127"sv, "128"sv, "-128"sv, "-129"sv, "255"sv, "256"sv, "32767"sv,
+        "-32768"sv, "65535"sv, "65536"sv, "2147483647"sv, "2147483648"sv,
+        "-2147483648"sv, "-2147483649"sv, "4294967295"sv, "4294967296"sv,
+        "9223372036854775807"sv, "9223372036854775808"sv,
+        "-9223372036854775808"sv, "-9223372036854775809"sv,
+        "18446744073709551615"sv, "18446744073709551616"sv,
+        "99999999999999999999"sv, "99999999999999999999x"sv, "1 "sv, " 1"sv,
+        "1.5"sv, "-0.25"sv, "+2.5"sv, "1.0f"sv, "1.0e"sv, "1e"sv, "1e5"sv,
+        "1E-5"sv, "12.5e-3"sv, ".5"sv, "5."sv, "."sv, "1..2"sv, "1.2.3"sv,
+        "1e5e"sv, "e5"sv, "f"sv, "-.5"sv, "3.14159265358979323846"sv,
+        "0.1"sv, "0.2"sv, "123456789012345678901234567890"sv, "1e300"sv,
+        "1e-300"sv, "2.2250738585072014e-308"sv, "1.7976931348623157e308"sv,
+        "1.7976931348623158e308"sv, "1.7976931348623159e308"sv, "4.9e-324"sv,
+        "2.4703282292062328e-324"sv, "2.4703282292062327e-324"sv, "1e-310"sv,
+        "2.2250738585072011e-308"sv, "9007199254740993"sv, "9007199254740995"sv,
+        "9007199254740993.0000000000000000001"sv, "16777217"sv, "16777219"sv,
+        "1e-45"sv, "7e-46"sv, "7.1e-46"sv, "1.1754942e-38"sv, "3.4028235e38"sv,
+        "3.40282357e38"sv, "1e22"sv, "1e23"sv, "123456789e-30"sv, "0e999999"sv,
+        "1e99999999999"sv, "1e-99999999999"sv, "-0.0"sv, "1e+5"sv, "1e-+5"sv,
+        "0x10"sv, "inf"sv, "-Infinity"sv, "infinit"sv, "nan"sv, "-nan(x_1)"sv,
+        "nan("sv, "NaN()"sv };
+
+    constexpr size_t DICTIONARY_SIZE = std::size(DICTIONARY);
+
+    template <typename T>
+    struct outcome
+    {
+        std::errc ec{};
+        T value{};
+    };
+
+    // Вычисления на этапе компиляции: ветви if consteval ядер
+    template <typename T, typename CharT>
+    constexpr std::array<outcome<T>, DICTIONARY_SIZE> consteval_outcomes = []()
+        {
+            std::array<outcome<T>, DICTIONARY_SIZE> out{};
+            for (size_t i = 0; i < DICTIONARY_SIZE; ++i)
+            {
+                CharT units[64]{};
+                const std::string_view entry = DICTIONARY[i];
+                for (size_t j = 0; j < entry.size(); ++j) units[j] = CharT(entry[j]);
+
+                const std::basic_string_view<CharT> field{ units, entry.size() };
+                if constexpr (std::is_integral_v<T>) out[i].ec = convert_integer(field, out[i].value);
+                else out[i].ec = convert_float(field, out[i].value);
+            }
+            return out;
+        }();
+
+    template <typename T, typename CharT>
+    void check_consteval_dictionary(const char* kernel)
+    {
+        for (size_t i = 0; i < DICTIONARY_SIZE; ++i)
+        {
+            const std::basic_string<CharT> field = widen<CharT>(DICTIONARY[i]);
+            T actual{};
+            std::errc actual_ec;
+            if constexpr (std::is_integral_v<T>)
+            {
+                actual_ec = convert_integer(std::basic_string_view<CharT>{ field }, actual);
+            }
+            else actual_ec = convert_float(std::basic_string_view<CharT>{ field }, actual);
+
+            const outcome<T>& expected = consteval_outcomes<T, CharT>[i];
+            expect(kernel, DICTIONARY[i], expected.ec, expected.value, actual_ec, actual);
+        }
+    }
+
+    /* parse_value разбирает только корректные значения (иначе --
+    ошибка компиляции), поэтому его словарь отдельный */
+    template <basic_fixed_string... entries>
+    void check_parse_value_int()
+    {
+        (..., [&]()
+            {
+                constexpr int expected = parse_value<entries, int>();
+                int actual = 0;
+                const std::errc ec = convert_integer(entries.sv(), actual);
+                expect("parse_value<int>", entries.sv(), std::errc{}, expected, ec, actual);
+            }());
+    }
+
+    template <typename Float, basic_fixed_string... entries>
+    void check_parse_value_float(const char* kernel)
+    {
+        (..., [&]()
+            {
+                constexpr Float expected = parse_value<entries, Float>();
+                Float actual = 0;
+                const std::errc ec = convert_float(entries.sv(), actual);
+                expect(kernel, entries.sv(), std::errc{}, expected, ec, actual);
+            }());
+    }
+
+    void check_compile_time()
+    {
+        check_consteval_dictionary<int8_t, char>("consteval convert_integer<int8_t>");
+        check_consteval_dictionary<uint16_t, char>("consteval convert_integer<uint16_t>");
+        check_consteval_dictionary<int32_t, char>("consteval convert_integer<int32_t>");
+        check_consteval_dictionary<int64_t, char>("consteval convert_integer<int64_t>");
+        check_consteval_dictionary<uint64_t, char>("consteval convert_integer<uint64_t>");
+        check_consteval_dictionary<int64_t, char16_t>("consteval convert_integer<char16_t>");
+        check_consteval_dictionary<uint64_t, char32_t>("consteval convert_integer<char32_t>");
+        check_consteval_dictionary<double, char>("consteval convert_float<double>");
+        check_consteval_dictionary<float, char>("consteval convert_float<float>");
+        check_consteval_dictionary<double, char16_t>("consteval convert_float<char16_t>");
+
+        check_parse_value_int<"0", "-0", "+0", "7", "-7", "+42", "00012",
+            "12345678", "123456789", "2147483647", "-2147483647">();
+        check_parse_value_float<double, "0", "1", "-1", "1.5", "-0.25", "+2.5", "1.0f",
+            "0.1", "3.14159", "1e5", "1E-5", "12.5e-3", "-7.125e2", "100000.5",
+            "0.123456789", "1.7976931e308", "4.9e-324", "2.5e-320", "1e-310",
+            "123456789.987654321", "1e22", "1e23">("parse_value<double>");
+        check_parse_value_float<float, "0.1", "3.14159", "16777217", "1.1754942e-38",
+            "1e-45", "3.4028235e38", "0.333333343">("parse_value<float>");
+    }
+
+#ifndef STDX_SCAN_LIBFUZZER
+    //=== Генерация входов ===
+    // Строки из 16 символов, в основном цифр
+    std::vector<char> make_rows(const size_t n, std::mt19937_64& rng)
+    {
+        std::vector<char> rows(n * DIGIT_ROW_SIZE);
+        for (char& c : rows)
+        {
+            const uint64_t roll = rng() % 64;
+            c = roll < 60 ? char('0' + roll % 10)
+                : roll == 60 ? '/' : roll == 61 ? ':' : char(rng());
+        }
+        return rows;
+    }
+
+    const std::string_view BOUNDARIES[] = {
+        "127"sv, "128"sv, "-128"sv, "-129"sv, "255"sv, "256"sv, "32767"sv,
+        "32768"sv, "-32768"sv, "-32769"sv, "65535"sv, "65536"sv,
+        "2147483647"sv, "2147483648"sv, "-2147483648"sv, "-2147483649"sv,
+        "4294967295"sv, "4294967296"sv, "9223372036854775807"sv,
+        "9223372036854775808"sv, "-9223372036854775808"sv,
+        "-9223372036854775809"sv, "18446744073709551615"sv,
+        "18446744073709551616"sv, "nan"sv, "inf"sv, "-inf"sv, "infinity"sv,
+        "0x10"sv, "1e308"sv, "1e309"sv, "4.9e-324"sv, "2e-324"sv };
+
+    std::string random_digits(std::mt19937_64& rng, size_t n)
+    {
+        std::string out;
+        for (size_t i = 0; i < n; ++i) out += char('0' + rng() % 10);
+        return out;
+    }
+
+    // Случайное, в основном почти корректное, число
+    std::string random_number(std::mt19937_64& rng)
+    {
+        std::string out;
+        switch (rng() % 4)
+        {
+        case 0: break;
+        case 1: out += '-'; break;
+        case 2: out += '+'; break;
+        default: if (rng() % 8 == 0) out += "+-"[rng() % 2]; break;
+        }
+
+        // Длины у границ блоков SWAR: 4, 8, 16 и 20 цифр
+        const size_t lengths[] = { 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 19, 20, 21, 30 };
+        out += random_digits(rng, (rng() % 2) ? lengths[rng() % std::size(lengths)]
+            : rng() % 24);
+
+        if (rng() % 3 == 0)
+        {
+            out += '.';
+            out += random_digits(rng, rng() % 18);
+        }
+        if (rng() % 5 == 0)
+        {
+            out += "eE"[rng() % 2];
+            if (rng() % 2) out += "+-"[rng() % 2];
+            out += random_digits(rng, rng() % 4);
+        }
+        if (rng() % 10 == 0) out += "fe"[rng() % 2];
+        return out;
+    }
+
+    /* Трудные для округления числа: окрестность середины между
+    соседними double или float.  Середина точно представима в long
+    double, а printf печатает её точно; при меньшей точности печати
+    получаются числа по обе стороны от неё.  Показатели -- в том числе
+    субнормальные, длина -- изредка до 800 значащих цифр */
+    std::string random_hard_float(std::mt19937_64& rng)
+    {
+        long double value = 0;
+        long double next = 0;
+        if (rng() % 2)
+        {
+            uint64_t bits = rng() & 0x7fef'ffff'ffff'ffffULL;
+            if (rng() % 4 == 0) bits &= 0x001f'ffff'ffff'ffffULL;
+            const double d = std::bit_cast<double>(bits);
+            value = d;
+            next = std::nextafter(d, std::numeric_limits<double>::infinity());
+        }
+        else
+        {
+            uint32_t bits = uint32_t(rng()) & 0x7f7f'ffffU;
+            if (rng() % 4 == 0) bits &= 0x00ff'ffffU;
+            const float f = std::bit_cast<float>(bits);
+            value = f;
+            next = std::nextafter(f, std::numeric_limits<float>::infinity());
+        }
+
+        const int precision = (rng() % 8) ? int(rng() % 40) : int(rng() % 800);
+        char buffer[1024];
+        std::snprintf(buffer, sizeof(buffer), "%s%.*Le", (rng() % 4) ? "" : "-",
+            precision, (value + next) / 2);
+
+        std::string out = buffer;
+        if (rng() % 4 == 0)
+        {
+            // Чуть больше середины: ненулевая цифра далеко за последней
+            const size_t exp_at = out.find('e');
+            out.insert(exp_at, std::string(rng() % 20, '0') + "1");
+        }
+        return out;
+    }
+
+    // Порча: замена, вставка и удаление байтов, соседних с цифрами в ASCII
+    std::string mutate(std::string input, std::mt19937_64& rng)
+    {
+        const char specials[] = { '/', ':', '.', '-', '+', 'e', 'f', ' ', '\0',
+            char(0xb0), char(0xb9), char(0x80) };
+
+        const size_t n = 1 + rng() % 3;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const size_t at = input.empty() ? 0 : rng() % (input.size() + 1);
+            const char c = (rng() % 2) ? specials[rng() % std::size(specials)] : char(rng());
+            switch (rng() % 3)
+            {
+            case 0: if (at < input.size()) input[at] = c; break;
+            case 1: input.insert(input.begin() + at, c); break;
+            default: if (at < input.size()) input.erase(at, 1); break;
+            }
+        }
+        return input;
+    }
+
+    std::string random_input(std::mt19937_64& rng)
+    {
+        switch (rng() % 9)
+        {
+        case 0: return std::string{ BOUNDARIES[rng() % std::size(BOUNDARIES)] };
+        case 1: return mutate(std::string{ DICTIONARY[rng() % DICTIONARY_SIZE] }, rng);
+        case 2: case 3: return mutate(random_number(rng), rng);
+        case 4: return random_hard_float(rng);
+        default: return random_number(rng);
+        }
+    }
+
+    //=== Замеры ===
+    struct options
+    {
+        uint64_t seed = 42;
+        size_t iterations = 200'000;
+        int repeats = 5;
+        bool csv = false;
+        std::vector<const char*> files;
+    };
+
+    template <typename Run>
+    double best_seconds(const options& opts, Run&& run)
+    {
+        double out = 1e300;
+        for (int r = 0; r < opts.repeats; ++r)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const auto stop = std::chrono::steady_clock::now();
+            out = std::min(out, std::chrono::duration<double>(stop - start).count());
+        }
+        return out;
+    }
+
+    volatile uint64_t sink = 0;
+
+    void report(const char* kernel, size_t values, size_t bytes, double seconds,
+        const options& opts)
+    {
+        if (opts.csv)
+        {
+            std::printf("%s,%.3f,%.0f\n", kernel, seconds * 1e9 / values, bytes / seconds);
+        }
+        else
+        {
+            std::printf("%-28s %10.2f %10.1f\n", kernel, seconds * 1e9 / values,
+                bytes / seconds / 1e6);
+        }
+    }
+
+    /* Пропускная способность ядер на корректных числах -- тех, что
+    встречаются в данных; каждое ядро получает одни и те же входы */
+    void measure_kernels(const options& opts, std::mt19937_64& rng)
+    {
+        std::vector<std::string> integers;
+        std::vector<std::string> floats;
+        for (size_t i = 0; i < 100'000; ++i)
+        {
+            integers.push_back((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 18));
+            floats.push_back((rng() % 2 ? "-" : "") + random_digits(rng, 1 + rng() % 6) +
+                "." + random_digits(rng, 1 + rng() % 8));
+        }
+
+        const auto bytes_of = [](const std::vector<std::string>& inputs)
+            {
+                size_t out = 0;
+                for (const std::string& s : inputs) out += s.size();
+                return out;
+            };
+        const size_t integer_bytes = bytes_of(integers);
+        const size_t float_bytes = bytes_of(floats);
+
+        std::vector<std::u16string> wide_integers;
+        for (const std::string& s : integers) wide_integers.push_back(widen<char16_t>(s));
+
+        if (opts.csv) std::printf("kernel,ns_per_value,bytes_per_s\n");
+        else std::printf("%-28s %10s %10s\n", "kernel", "ns/value", "MB/s");
+
+        report("convert_integer<char>", integers.size(), integer_bytes,
+            best_seconds(opts, [&]()
+                {
+                    uint64_t sum = 0;
+                    for (const std::string& s : integers)
+                    {
+                        int64_t v = 0;
+                        convert_integer(std::string_view{ s }, v);
+                        sum += v;
+                    }
+                    sink = sum;
+                }), opts);
+
+        report("convert_integer<char16_t>", integers.size(), integer_bytes * 2,
+            best_seconds(opts, [&]()
+                {
+                    uint64_t sum = 0;
+                    for (const std::u16string& s : wide_integers)
+                    {
+                        int64_t v = 0;
+                        convert_integer(std::u16string_view{ s }, v);
+                        sum += v;
+                    }
+                    sink = sum;
+                }), opts);
+
+        report("from_chars<int64_t>", integers.size(), integer_bytes,
+            best_seconds(opts, [&]()
+                {
+                    uint64_t sum = 0;
+                    for (const std::string& s : integers)
+                    {
+                        int64_t v = 0;
+                        std::from_chars(s.data(), s.data() + s.size(), v);
+                        sum += v;
+                    }
+                    sink = sum;
+                }), opts);
+
+        report("convert_float<char>", floats.size(), float_bytes,
+            best_seconds(opts, [&]()
+                {
+                    double sum = 0;
+                    for (const std::string& s : floats)
+                    {
+                        double v = 0;
+                        convert_float(std::string_view{ s }, v);
+                        sum += v;
+                    }
+                    sink = std::bit_cast<uint64_t>(sum);
+                }), opts);
+
+        report("from_chars<double>", floats.size(), float_bytes,
+            best_seconds(opts, [&]()
+                {
+                    double sum = 0;
+                    for (const std::string& s : floats)
+                    {
+                        double v = 0;
+                        std::from_chars(s.data(), s.data() + s.size(), v);
+                        sum += v;
+                    }
+                    sink = std::bit_cast<uint64_t>(sum);
+                }), opts);
+
+        // Пакетные ядра: поля -- записи целиком
+        const auto measure_column = [&]<typename T>(const char* kernel,
+            const std::vector<std::string>& inputs, size_t bytes)
+            {
+                const std::vector<std::string_view> views(inputs.begin(), inputs.end());
+                column_workspace ws;
+                std::vector<T> out(BATCH_BLOCK_SIZE);
+                std::vector<uint8_t> valid(BATCH_BLOCK_SIZE);
+
+                report(kernel, inputs.size(), bytes, best_seconds(opts, [&]()
+                    {
+                        uint64_t sum = 0;
+                        for (size_t first = 0; first < views.size(); first += BATCH_BLOCK_SIZE)
+                        {
+                            const size_t n = std::min(BATCH_BLOCK_SIZE, views.size() - first);
+                            std::fill(valid.begin(), valid.end(), 1);
+                            if constexpr (std::is_integral_v<T>)
+                            {
+                                convert_integer_column(views.data() + first, views.data() + first,
+                                    n, out.data(), valid.data(), ws);
+                            }
+                            else
+                            {
+                                convert_float_column(views.data() + first, views.data() + first,
+                                    n, out.data(), valid.data(), ws);
+                            }
+                            sum += static_cast<uint64_t>(out[0]) + valid[n - 1];
+                        }
+                        sink = sum;
+                    }), opts);
+            };
+        measure_column.template operator()<int64_t>("convert_integer_column", integers,
+            integer_bytes);
+        measure_column.template operator()<double>("convert_float_column", floats,
+            float_bytes);
+
+        // Ядра строк цифр
+        constexpr size_t n_rows = BATCH_BLOCK_SIZE;
+        std::vector<char> rows(n_rows * DIGIT_ROW_SIZE);
+        for (char& c : rows) c = char('0' + rng() % 10);
+        std::vector<uint64_t> values(n_rows);
+        std::vector<uint8_t> ok(n_rows);
+        constexpr size_t row_rounds = 400;
+
+        const auto measure_rows = [&](const char* kernel, auto&& convert)
+            {
+                report(kernel, n_rows * row_rounds, rows.size() * row_rounds,
+                    best_seconds(opts, [&]()
+                        {
+                            uint64_t sum = 0;
+                            for (size_t i = 0; i < row_rounds; ++i)
+                            {
+                                convert(rows.data(), n_rows, values.data(), ok.data());
+                                sum += values[i % n_rows];
+                            }
+                            sink = sum;
+                        }), opts);
+            };
+
+        measure_rows("convert_row_scalar", [](const char* r, size_t n, uint64_t* out,
+            uint8_t* o)
+            {
+                for (size_t i = 0; i < n; ++i) o[i] = convert_row_scalar(r + i * DIGIT_ROW_SIZE, out[i]);
+            });
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+        const digit_kernel best = get_digit_kernel();
+        if (best >= digit_kernel::sse41) measure_rows("convert_rows_sse41", convert_rows_sse41);
+        if (best >= digit_kernel::avx2) measure_rows("convert_rows_avx2", convert_rows_avx2);
+        if (best >= digit_kernel::avx512) measure_rows("convert_rows_avx512", convert_rows_avx512);
+#endif
+    }
+
+    void run_fuzz(const options& opts, std::mt19937_64& rng)
+    {
+        std::vector<std::string> integer_column;
+        std::vector<std::string> float_column;
+
+        for (size_t i = 0; i < opts.iterations; ++i)
+        {
+            const std::string input = random_input(rng);
+            check_all(input);
+
+            integer_column.push_back(input);
+            float_column.push_back(input);
+            if (integer_column.size() == 4 * BATCH_BLOCK_SIZE)
+            {
+                check_column<int64_t>(integer_column, rng);
+                check_column<uint32_t>(integer_column, rng);
+                check_column<double>(float_column, rng);
+                check_column<float>(float_column, rng);
+                integer_column.clear();
+                float_column.clear();
+                check_rows(make_rows(257, rng));
+            }
+        }
+        check_column<int64_t>(integer_column, rng);
+        check_column<double>(float_column, rng);
+    }
+
+    bool read_file(const char* path, std::string& out)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+#endif
+}  // namespace
+
+#ifdef STDX_SCAN_LIBFUZZER
+// Словарь этапа компиляции проверяется один раз при запуске
+extern "C" int LLVMFuzzerInitialize(int*, char***)
+{
+    check_compile_time();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string_view input{ reinterpret_cast<const char*>(data), size };
+    check_all(input);
+
+    std::mt19937_64 rng{ size };
+    check_column<int64_t>({ std::string{ input } }, rng);
+    check_column<double>({ std::string{ input } }, rng);
+
+    // Вход, дополненный нулями до целого числа строк
+    std::vector<char> rows(input.begin(), input.end());
+    rows.resize((rows.size() + DIGIT_ROW_SIZE - 1) / DIGIT_ROW_SIZE * DIGIT_ROW_SIZE, '0');
+    check_rows(rows);
+    return 0;
+}
+#else
+int main(int argc, char* argv[])
+{
+    options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) opts.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            opts.iterations = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--repeats" && i + 1 < argc) opts.repeats = std::atoi(argv[++i]);
+        else if (arg == "--csv") opts.csv = true;
+        else if (!arg.starts_with("--")) opts.files.push_back(argv[i]);
+        else
+        {
+            std::fprintf(stderr, "usage: convert_fuzz [--seed N] [--iterations N] "
+                "[--repeats N] [--csv] [files...]\n");
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng{ opts.seed };
+
+    check_compile_time();
+
+    for (const char* path : opts.files)
+    {
+        std::string input;
+        if (!read_file(path, input))
+        {
+            std::fprintf(stderr, "cannot read %s\n", path);
+            return 2;
+        }
+        check_all(input);
+    }
+
+    run_fuzz(opts, rng);
+    measure_kernels(opts, rng);
+
+    std::fprintf(stderr, "%zu inputs, %zu mismatches\n",
+        opts.iterations + opts.files.size(), n_mismatches);
+    return n_mismatches ? 1 : 0;
+}
+#endif
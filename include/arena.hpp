@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace stdx::internals
+{
+    /* Арена для значений, которые нельзя вернуть видом на исходную
+    строку (разэкранированные строки %q).  Память выделяется блоками
+    и освобождается целиком при reset() или уничтожении арены, поэтому
+    string_view на её содержимое действительны до этого момента */
+    class scan_arena
+    {
+    public:
+        constexpr static const size_t DEFAULT_BLOCK_SIZE = 4096;
+
+        constexpr explicit scan_arena(size_t block_size = DEFAULT_BLOCK_SIZE) :
+            block_size{block_size}
+        {}
+
+        scan_arena(const scan_arena&) = delete;
+        scan_arena& operator=(const scan_arena&) = delete;
+
+        constexpr ~scan_arena()
+        {
+            for (const block& b : blocks) delete[] b.data;
+        }
+
+        // Выделение size байт; блоки больше block_size выделяются отдельно
+        constexpr char* allocate(size_t size)
+        {
+            while (current < blocks.size())
+            {
+                block& b = blocks[current];
+                if (b.capacity - b.used >= size)
+                {
+                    char* out = b.data + b.used;
+                    b.used += size;
+                    return out;
+                }
+                ++current;
+            }
+
+            const size_t capacity = (size > block_size) ? size : block_size;
+            blocks.push_back({ new char[capacity], capacity, size });
+            current = blocks.size() - 1;
+            return blocks.back().data;
+        }
+
+        /* Выделение size кодовых единиц CharT.  Блоки выделяются как
+        массивы char, поэтому для широких единиц место выравнивается
+        вручную; на этапе компиляции такое выделение недоступно и
+        возвращается nullptr */
+        template <typename CharT>
+        constexpr CharT* allocate_units(size_t size)
+        {
+            if constexpr (std::is_same_v<CharT, char>) return allocate(size);
+            else
+            {
+                if consteval { return nullptr; }
+                else
+                {
+                    char* raw = allocate(size * sizeof(CharT) + alignof(CharT) - 1);
+                    void* data = raw;
+                    size_t space = size * sizeof(CharT) + alignof(CharT) - 1;
+                    return static_cast<CharT*>(
+                        std::align(alignof(CharT), size * sizeof(CharT), data, space));
+                }
+            }
+        }
+
+        // Освобождение всех значений с сохранением блоков для повторного использования
+        constexpr void reset()
+        {
+            for (block& b : blocks) b.used = 0;
+            current = 0;
+        }
+
+    private:
+        struct block
+        {
+            char* data;
+            size_t capacity;
+            size_t used;
+        };
+
+        std::vector<block> blocks;
+        size_t current = 0;
+        size_t block_size;
+    };
+}  // namespace stdx::internals
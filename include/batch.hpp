@@ -0,0 +1,683 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "parse.hpp"
+#include "arena.hpp"
+#include "convert.hpp"
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define STDX_SCAN_HAS_DIGIT_KERNELS 1
+#endif
+
+namespace stdx::internals
+{
+    /* Пакетное сканирование по столбцам.  Записи обрабатываются блоками
+    по BATCH_BLOCK_SIZE: сначала для всего блока ищутся границы полей,
+    затем поля каждого плейсхолдера преобразуются подряд.  Цифры
+    числовых полей выравниваются по правому краю в строки по
+    DIGIT_ROW_SIZE байт, и строки преобразуются векторными ядрами --
+    по одной (SSE4.1), две (AVX2) или четыре (AVX-512BW) за инструкцию.
+    Набор инструкций выбирается во время исполнения, без -march.
+
+    Разбиение на этапы стоит несколько наносекунд на поле (границы
+    сохраняются и читаются заново, каждый столбец -- отдельный проход)
+    и окупается только на дорогих преобразованиях: числах с плавающей
+    точкой (быстрый путь Клингера вместо std::from_chars) и 64-битных
+    целых (до 19 цифр).  Форматы, где таких полей меньше трети,
+    сканируются по записям -- см. prefers_columns */
+    constexpr const size_t BATCH_BLOCK_SIZE = 256;
+    constexpr const size_t DIGIT_ROW_SIZE = 16;
+
+    //=== Ядра преобразования строк цифр ===
+    /* Строка -- 16 символов '0'..'9' старшими разрядами вперёд.
+    Возвращает false, если в строке есть не цифра */
+    constexpr bool convert_row_scalar(const char* row, uint64_t& out)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < DIGIT_ROW_SIZE; ++i)
+        {
+            const uint64_t digit = static_cast<unsigned char>(row[i] - '0');
+            if (digit > 9) return false;
+            value = value * 10 + digit;
+        }
+        out = value;
+        return true;
+    }
+
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+    /* Цифры складываются попарно (maddubs), четвёрками (madd),
+    упаковываются в 16 бит (packus) и складываются восьмёрками (madd);
+    старшая восьмёрка умножается на 10^8 и складывается с младшей в
+    64-битной полосе (mul_epu32).  Все операции -- внутри 128-битных
+    полос, поэтому одни и те же шаги обрабатывают одну строку в SSE,
+    две в AVX2 и четыре в AVX-512 */
+    __attribute__((target("sse4.1")))
+    inline void convert_rows_sse41(const char* rows, size_t n, uint64_t* out,
+        uint8_t* ok)
+    {
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i mul10 = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+            10, 1, 10, 1, 10, 1, 10, 1);
+        const __m128i mul100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+        const __m128i mul10000 = _mm_setr_epi16(10000, 1, 10000, 1,
+            10000, 1, 10000, 1);
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            const __m128i digits = _mm_sub_epi8(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(rows + r * DIGIT_ROW_SIZE)), zero);
+            ok[r] = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_max_epu8(digits, nine), nine)) == 0xFFFF;
+
+            const __m128i pairs = _mm_maddubs_epi16(digits, mul10);
+            const __m128i quads = _mm_madd_epi16(pairs, mul100);
+            const __m128i octs = _mm_madd_epi16(
+                _mm_packus_epi32(quads, quads), mul10000);
+
+            const __m128i value = _mm_add_epi64(
+                _mm_mul_epu32(octs, _mm_set1_epi64x(100'000'000)),
+                _mm_srli_epi64(octs, 32));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + r), value);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline void convert_rows_avx2(const char* rows, size_t n, uint64_t* out,
+        uint8_t* ok)
+    {
+        const __m256i zero = _mm256_set1_epi8('0');
+        const __m256i nine = _mm256_set1_epi8(9);
+        const __m256i mul10 = _mm256_set1_epi16(0x010A);
+        const __m256i mul100 = _mm256_set1_epi32(0x0001'0064);
+        const __m256i mul10000 = _mm256_set1_epi32(0x0001'2710);
+
+        size_t r = 0;
+        for (; r + 2 <= n; r += 2)
+        {
+            const __m256i digits = _mm256_sub_epi8(_mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(rows + r * DIGIT_ROW_SIZE)), zero);
+            const uint32_t valid = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_max_epu8(digits, nine), nine)));
+
+            const __m256i pairs = _mm256_maddubs_epi16(digits, mul10);
+            const __m256i quads = _mm256_madd_epi16(pairs, mul100);
+            const __m256i octs = _mm256_madd_epi16(
+                _mm256_packus_epi32(quads, quads), mul10000);
+
+            // Значения строк -- в 64-битных полосах 0 и 2
+            const __m256i value = _mm256_add_epi64(
+                _mm256_mul_epu32(octs, _mm256_set1_epi64x(100'000'000)),
+                _mm256_srli_epi64(octs, 32));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + r),
+                _mm256_castsi256_si128(_mm256_permute4x64_epi64(value, 0b10'00)));
+
+            ok[r] = (valid & 0xFFFF) == 0xFFFF;
+            ok[r + 1] = (valid >> 16) == 0xFFFF;
+        }
+        convert_rows_sse41(rows + r * DIGIT_ROW_SIZE, n - r, out + r, ok + r);
+    }
+
+    /* Признаки строк из маски сравнения: бит 16 * i установлен, если
+    все 16 байт i-й строки -- цифры; результат -- по байту 0/1 на строку
+    в младших 32 битах */
+    constexpr uint32_t get_row_flags(uint64_t valid)
+    {
+        valid &= valid >> 8;
+        valid &= valid >> 4;
+        valid &= valid >> 2;
+        valid &= (valid >> 1) & 0x0001'0001'0001'0001ULL;
+
+        // Биты 0, 16, 32, 48 -- в биты 0, 8, 16, 24
+        valid |= valid >> 8;
+        return static_cast<uint32_t>((valid & 0xFFFF) | ((valid >> 16) & 0xFFFF'0000));
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    inline __m512i convert_rows_avx512_step(const char* rows, uint64_t& valid)
+    {
+        const __m512i digits = _mm512_sub_epi8(_mm512_loadu_si512(rows),
+            _mm512_set1_epi8('0'));
+        valid = _mm512_cmple_epu8_mask(digits, _mm512_set1_epi8(9));
+
+        const __m512i pairs = _mm512_maddubs_epi16(digits, _mm512_set1_epi16(0x010A));
+        const __m512i quads = _mm512_madd_epi16(pairs, _mm512_set1_epi32(0x0001'0064));
+        const __m512i octs = _mm512_madd_epi16(
+            _mm512_packus_epi32(quads, quads), _mm512_set1_epi32(0x0001'2710));
+
+        // Значения строк -- в чётных 64-битных полосах
+        return _mm512_add_epi64(
+            _mm512_mul_epu32(octs, _mm512_set1_epi64(100'000'000)),
+            _mm512_srli_epi64(octs, 32));
+    }
+
+    /* Восемь строк за шаг: две загрузки по четыре строки, чётные полосы
+    обеих сводятся одной перестановкой в одну запись, а признаки строк
+    получаются из масок сравнения без цикла */
+    __attribute__((target("avx512f,avx512bw")))
+    inline void convert_rows_avx512(const char* rows, size_t n, uint64_t* out,
+        uint8_t* ok)
+    {
+        const __m512i even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+
+        size_t r = 0;
+        for (; r + 8 <= n; r += 8)
+        {
+            uint64_t low_valid;
+            uint64_t high_valid;
+            const __m512i low = convert_rows_avx512_step(
+                rows + r * DIGIT_ROW_SIZE, low_valid);
+            const __m512i high = convert_rows_avx512_step(
+                rows + (r + 4) * DIGIT_ROW_SIZE, high_valid);
+
+            _mm512_storeu_si512(out + r, _mm512_permutex2var_epi64(low, even, high));
+
+            const uint64_t flags = get_row_flags(low_valid) |
+                static_cast<uint64_t>(get_row_flags(high_valid)) << 32;
+            std::memcpy(ok + r, &flags, sizeof(flags));
+        }
+        convert_rows_avx2(rows + r * DIGIT_ROW_SIZE, n - r, out + r, ok + r);
+    }
+
+    enum class digit_kernel : uint8_t { scalar, sse41, avx2, avx512 };
+
+    /* Лучшее ядро для текущего процессора, определяется один раз.
+    AVX-512 -- первым: по замерам convert_fuzz восемь строк за шаг
+    быстрее AVX2 (около 1,2 против 1,8 нс на строку) */
+    inline digit_kernel get_digit_kernel()
+    {
+        static const digit_kernel out = []()
+            {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512bw")) return digit_kernel::avx512;
+                if (__builtin_cpu_supports("avx2")) return digit_kernel::avx2;
+                if (__builtin_cpu_supports("sse4.1")) return digit_kernel::sse41;
+                return digit_kernel::scalar;
+            }();
+        return out;
+    }
+#endif
+
+    // Преобразование n строк цифр; ok[r] -- все ли символы строки цифры
+    constexpr void convert_rows(const char* rows, size_t n, uint64_t* out,
+        uint8_t* ok)
+    {
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+        if !consteval
+        {
+            switch (get_digit_kernel())
+            {
+            case digit_kernel::avx512: return convert_rows_avx512(rows, n, out, ok);
+            case digit_kernel::avx2: return convert_rows_avx2(rows, n, out, ok);
+            case digit_kernel::sse41: return convert_rows_sse41(rows, n, out, ok);
+            default: break;
+            }
+        }
+#endif
+        for (size_t r = 0; r < n; ++r)
+        {
+            ok[r] = convert_row_scalar(rows + r * DIGIT_ROW_SIZE, out[r]);
+        }
+    }
+
+    //=== Преобразование столбцов ===
+    // Буферы этапа преобразования, общие для всех столбцов блока
+    struct column_workspace
+    {
+        std::array<char, BATCH_BLOCK_SIZE * DIGIT_ROW_SIZE> rows{};
+        std::array<uint64_t, BATCH_BLOCK_SIZE> values{};
+        std::array<uint8_t, BATCH_BLOCK_SIZE> digits_ok{};
+        std::array<uint8_t, BATCH_BLOCK_SIZE> is_negative{};
+        std::array<int8_t, BATCH_BLOCK_SIZE> frac_size{};
+
+        // Поле не помещается в строку и преобразуется по одному
+        std::array<uint8_t, BATCH_BLOCK_SIZE> is_scalar{};
+    };
+
+    /* Символы поля выравниваются по правому краю строки row.  Поле
+    пишется слева направо в буфер за 16 нулями, а строка копируется
+    целиком, заканчиваясь на последнем символе, -- без копирований
+    переменной длины.  Первая десятичная точка при allow_point
+    пропускается, и frac_size -- число символов после неё.  Символы не
+    проверяются: это делает ядро.  Возвращает число символов строки
+    либо npos, если поле в строку не помещается */
+    constexpr size_t stage_digits(std::string_view field, char* row,
+        bool allow_point, size_t& frac_size)
+    {
+        char buffer[2 * DIGIT_ROW_SIZE];
+        std::fill_n(buffer, DIGIT_ROW_SIZE, '0');
+
+        size_t size = 0;
+        size_t point = std::string_view::npos;
+        for (const char c : field)
+        {
+            if (c == '.' && allow_point && point == std::string_view::npos)
+            {
+                point = size;
+                continue;
+            }
+            if (size == DIGIT_ROW_SIZE) return std::string_view::npos;
+            buffer[DIGIT_ROW_SIZE + size++] = c;
+        }
+
+        std::copy_n(buffer + size, DIGIT_ROW_SIZE, row);
+        frac_size = (point == std::string_view::npos) ? 0 : size - point;
+        return size;
+    }
+
+    // Знак поля отделяется; '-' отмечается в is_negative
+    constexpr std::string_view strip_sign(std::string_view field,
+        uint8_t& is_negative)
+    {
+        is_negative = !field.empty() && field.front() == '-';
+        if (!field.empty() && (field.front() == '-' || field.front() == '+'))
+        {
+            field.remove_prefix(1);
+        }
+        return field;
+    }
+
+    /* Подготовка r-й строки столбца: знак, цифры, число цифр после
+    точки.  Поля, не помещающиеся в строку (более max_digits цифр),
+    отмечаются is_scalar и преобразуются по одному */
+    constexpr void stage_field(std::string_view span, size_t r,
+        bool allow_point, size_t max_digits, column_workspace& ws)
+    {
+        char* row = ws.rows.data() + r * DIGIT_ROW_SIZE;
+        const std::string_view field = strip_sign(span, ws.is_negative[r]);
+
+        size_t frac_size = 0;
+        const size_t size = span.starts_with("+-")
+            ? std::string_view::npos
+            : stage_digits(field, row, allow_point, frac_size);
+
+        ws.is_scalar[r] = !size || size > max_digits;
+        ws.frac_size[r] = static_cast<int8_t>(frac_size);
+        if (ws.is_scalar[r]) std::fill_n(row, DIGIT_ROW_SIZE, '0');
+    }
+
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+    /* Векторная подготовка строк.  16 байт читаются так, чтобы не
+    выйти за пределы записи: заканчивая концом поля (поле сразу
+    выровнено по правому краю) либо начиная его началом со сдвигом
+    вправо (pshufb).  Единственная точка удаляется сдвигом старших
+    разрядов на байт, лишние байты заменяются '0' (blendv).  Поля,
+    у которых ни одно окно не помещается в запись, готовятся stage_field */
+    __attribute__((target("sse4.1")))
+    inline void stage_column_sse41(const std::string_view* spans,
+        const std::string_view* records, size_t n, const uint8_t* valid,
+        bool allow_point, size_t max_digits, column_workspace& ws)
+    {
+        const __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+            8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i zeros = _mm_set1_epi8('0');
+        const __m128i dot = _mm_set1_epi8('.');
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            char* row = ws.rows.data() + r * DIGIT_ROW_SIZE;
+            if (!valid[r])
+            {
+                ws.is_scalar[r] = true;
+                continue;
+            }
+
+            const std::string_view field = strip_sign(spans[r], ws.is_negative[r]);
+            const char* begin = field.data();
+            const char* end = begin + field.size();
+            const char* record_begin = records[r].data();
+            const char* record_end = record_begin + records[r].size();
+
+            int size = static_cast<int>(field.size());
+            if (!size || size > int(DIGIT_ROW_SIZE) || spans[r].starts_with("+-"))
+            {
+                stage_field(spans[r], r, allow_point, max_digits, ws);
+                continue;
+            }
+
+            __m128i chars;
+            if (end - record_begin >= int(DIGIT_ROW_SIZE))
+            {
+                chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                    end - DIGIT_ROW_SIZE));
+            }
+            else if (record_end - begin >= int(DIGIT_ROW_SIZE))
+            {
+                chars = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)),
+                    _mm_sub_epi8(iota, _mm_set1_epi8(char(DIGIT_ROW_SIZE - size))));
+            }
+            else
+            {
+                stage_field(spans[r], r, allow_point, max_digits, ws);
+                continue;
+            }
+
+            int frac_size = 0;
+            if (allow_point)
+            {
+                const unsigned dots = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(chars, dot),
+                        _mm_cmpgt_epi8(iota, _mm_set1_epi8(char(15 - size))))));
+
+                // Несколько точек -- ошибку найдёт ядро
+                if (dots && !(dots & (dots - 1)))
+                {
+                    const int point = std::countr_zero(dots);
+                    chars = _mm_shuffle_epi8(chars, _mm_add_epi8(iota,
+                        _mm_cmpgt_epi8(_mm_set1_epi8(char(point + 1)), iota)));
+                    --size;
+                    frac_size = 15 - point;
+                }
+            }
+
+            ws.is_scalar[r] = !size || size_t(size) > max_digits;
+            ws.frac_size[r] = static_cast<int8_t>(frac_size);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm_blendv_epi8(
+                zeros, chars, _mm_cmpgt_epi8(iota, _mm_set1_epi8(char(15 - size)))));
+        }
+    }
+#endif
+
+    /* Подготовка строк столбца.  records -- записи, которым принадлежат
+    поля: в их пределах разрешено читать по 16 байт */
+    constexpr void stage_column(const std::string_view* spans,
+        const std::string_view* records, size_t n, const uint8_t* valid,
+        bool allow_point, size_t max_digits, column_workspace& ws)
+    {
+#ifdef STDX_SCAN_HAS_DIGIT_KERNELS
+        if !consteval
+        {
+            if (get_digit_kernel() != digit_kernel::scalar)
+            {
+                return stage_column_sse41(spans, records, n, valid,
+                    allow_point, max_digits, ws);
+            }
+        }
+#endif
+        for (size_t r = 0; r < n; ++r)
+        {
+            if (valid[r]) stage_field(spans[r], r, allow_point, max_digits, ws);
+            else ws.is_scalar[r] = true;
+        }
+    }
+
+    /* Столбец целых чисел.  Поля до 16 цифр со знаком преобразуются
+    векторными ядрами, длинные -- convert_integer.  valid[r] сбрасывается
+    при ошибке преобразования */
+    template <typename Int>
+    constexpr void convert_integer_column(const std::string_view* spans,
+        const std::string_view* records, size_t n, Int* out, uint8_t* valid,
+        column_workspace& ws)
+    {
+        stage_column(spans, records, n, valid, false, DIGIT_ROW_SIZE, ws);
+
+        convert_rows(ws.rows.data(), n, ws.values.data(), ws.digits_ok.data());
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            if (!valid[r]) continue;
+
+            if (ws.is_scalar[r])
+            {
+                valid[r] = convert_integer(spans[r], out[r]) == std::errc{};
+                continue;
+            }
+
+            const uint64_t value = ws.values[r];
+            if (!ws.digits_ok[r])
+            {
+                valid[r] = false;
+            }
+            else if constexpr (std::is_signed_v<Int>)
+            {
+                using UInt = std::make_unsigned_t<Int>;
+                const uint64_t limit = static_cast<uint64_t>(
+                    std::numeric_limits<Int>::max()) + ws.is_negative[r];
+
+                valid[r] = value <= limit;
+                out[r] = ws.is_negative[r]
+                    ? static_cast<Int>(UInt{0} - static_cast<UInt>(value))
+                    : static_cast<Int>(value);
+            }
+            else
+            {
+                valid[r] = (!ws.is_negative[r] || !value) &&
+                    value <= std::numeric_limits<Int>::max();
+                out[r] = static_cast<Int>(value);
+            }
+        }
+    }
+
+    /* Столбец чисел с плавающей точкой.  Десятичные дроби [-+]ddd.ddd
+    без степени с мантиссой, точно представимой в типе (до 15 цифр
+    для double, до 7 для float), вычисляются быстрым путём Клингера:
+    мантисса из векторного ядра, делённая на точную степень 10, --
+    результат округлён корректно и совпадает с std::from_chars.
+    Остальные поля преобразуются convert_float */
+    template <typename Float>
+    constexpr void convert_float_column(const std::string_view* spans,
+        const std::string_view* records, size_t n, Float* out, uint8_t* valid,
+        column_workspace& ws)
+    {
+        constexpr size_t max_digits = std::is_same_v<Float, float> ? 7 : 15;
+        constexpr Float pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+            1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+
+        stage_column(spans, records, n, valid, true, max_digits, ws);
+
+        convert_rows(ws.rows.data(), n, ws.values.data(), ws.digits_ok.data());
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            if (!valid[r]) continue;
+
+            // Точка, степень или суффикс среди цифр -- общий путь
+            if (ws.is_scalar[r] || !ws.digits_ok[r])
+            {
+                valid[r] = convert_float(spans[r], out[r]) == std::errc{};
+                continue;
+            }
+
+            const Float value = static_cast<Float>(ws.values[r]) /
+                pow10[ws.frac_size[r]];
+            out[r] = ws.is_negative[r] ? -value : value;
+        }
+    }
+
+    //=== Пакетный сканер ===
+    // Столбцы значений: I-й столбец -- значения I-го плейсхолдера всех записей
+    template <typename... Ts>
+    struct column_batch
+    {
+        std::tuple<std::vector<std::remove_cv_t<Ts>>...> columns;
+
+        // 1, если запись совпала с форматом и все значения преобразованы
+        std::vector<uint8_t> valid;
+
+        constexpr size_t size() const { return valid.size(); }
+
+        template <size_t I>
+        constexpr const auto& column() const { return std::get<I>(columns); }
+    };
+
+    /* Окупается ли разбиение на этапы.  Замеры scan_bench: этапы
+    добавляют около 10 нс на поле, а поле с плавающей точкой или
+    64-битное целое экономит около 30 нс -- безубыточность около трети
+    таких полей */
+    template <typename... Ts>
+    consteval bool prefers_columns()
+    {
+        constexpr size_t n_heavy = (... + size_t(
+            std::is_floating_point_v<std::remove_cv_t<Ts>> ||
+            (std::is_integral_v<std::remove_cv_t<Ts>> && sizeof(Ts) == 8)));
+        return 3 * n_heavy >= sizeof...(Ts);
+    }
+
+    template <format_string format>
+    struct batch_scanner
+    {
+        template <typename... Ts>
+        [[nodiscard]] constexpr static column_batch<Ts...>
+        scan(std::span<const std::string_view> records,
+            scan_arena* arena = nullptr)
+        {
+            column_batch<Ts...> out;
+            scan(records, out, arena);
+            return out;
+        }
+
+        /* Сканирование в столбцы out.  Повторно используемый out не
+        выделяет память заново: свежие столбцы стоят страничных
+        прерываний и обнуления, сопоставимых со всем разбором */
+        template <typename... Ts>
+        constexpr static void scan(std::span<const std::string_view> records,
+            column_batch<Ts...>& out, scan_arena* arena = nullptr)
+        {
+            static_assert((... && is_supported_type_v<Ts>),
+                "Only integral types, float, double and "
+                "std::string_view are accepted; "
+                "references are not permitted");
+            static_assert(sizeof...(Ts) == format.n_placeholders,
+                "The number of types does not match the format string");
+            static_assert(std::is_same_v<typename decltype(format)::char_type, char> &&
+                (... && is_compatible_view_v<Ts, char>),
+                "Batch scanning supports only char format strings");
+
+            out.valid.assign(records.size(), 1);
+            std::apply([&](auto&... column)
+                {
+                    (..., column.resize(records.size()));
+                }, out.columns);
+
+            if constexpr (!prefers_columns<Ts...>())
+            {
+                scan_records<Ts...>(records, out, arena);
+                return;
+            }
+
+            std::vector<std::string_view> spans(
+                format.n_placeholders * BATCH_BLOCK_SIZE);
+            column_workspace ws;
+
+            for (size_t first = 0; first < records.size();
+                first += BATCH_BLOCK_SIZE)
+            {
+                const size_t n = std::min(BATCH_BLOCK_SIZE,
+                    records.size() - first);
+                uint8_t* valid = out.valid.data() + first;
+
+                // Этап 1: границы полей всех записей блока
+                for (size_t r = 0; r < n; ++r)
+                {
+                    const field_region region =
+                        anchor_fields<format>(records[first + r]);
+                    const std::string_view fields =
+                        records[first + r].substr(0, region.end);
+                    size_t pos = region.begin;
+                    valid[r] = (pos != std::string_view::npos) &&
+                        [&]<size_t... I>(indices<I...>)
+                        {
+                            return (... && find_span<I>(fields, pos,
+                                spans[I * BATCH_BLOCK_SIZE + r]));
+                        }(generate_indices<format.n_placeholders>{});
+                }
+
+                // Этап 2: преобразование по столбцам
+                [&]<size_t... I>(indices<I...>)
+                {
+                    (..., convert_column<I, Ts>(
+                        spans.data() + I * BATCH_BLOCK_SIZE,
+                        records.data() + first, n,
+                        std::get<I>(out.columns).data() + first,
+                        valid, ws, arena));
+                }(generate_indices<format.n_placeholders>{});
+            }
+        }
+
+    private:
+        // Сканирование по записям -- для форматов, где этапы не окупаются
+        template <typename... Ts>
+        constexpr static void scan_records(std::span<const std::string_view> records,
+            column_batch<Ts...>& out, scan_arena* arena)
+        {
+            for (size_t r = 0; r < records.size(); ++r)
+            {
+                const std::expected<scan_result<Ts...>, scan_error> result =
+                    scanner<format>::template scan<Ts...>(records[r], arena);
+                if (!result)
+                {
+                    out.valid[r] = 0;
+                    continue;
+                }
+
+                [&]<size_t... I>(indices<I...>)
+                {
+                    (..., (std::get<I>(out.columns)[r] = std::get<I>(result->values)));
+                }(generate_indices<format.n_placeholders>{});
+            }
+        }
+
+        template <size_t I>
+        constexpr static bool find_span(std::string_view source, size_t& pos,
+            std::string_view& out)
+        {
+            const std::expected<field_bounds, mismatch_reason> bounds =
+                find_placeholder_field<I, format_shape<format>{}>(source, pos);
+            if (!bounds) return false;
+
+            pos = bounds->next;
+            out = source.substr(bounds->begin, bounds->end - bounds->begin);
+            return true;
+        }
+
+        template <size_t I, typename T>
+        constexpr static void convert_column(const std::string_view* spans,
+            const std::string_view* records, size_t n,
+            std::remove_cv_t<T>* out, uint8_t* valid, column_workspace& ws,
+            scan_arena* arena)
+        {
+            using U = std::remove_cv_t<T>;
+
+            constexpr char format_c = get_specifier<I, format>();
+            if constexpr (format_c != '\0')
+            {
+                format_value<format_c, T>();
+            }
+
+            if constexpr (std::is_integral_v<U>)
+            {
+                convert_integer_column(spans, records, n, out, valid, ws);
+            }
+            else if constexpr (std::is_floating_point_v<U>)
+            {
+                convert_float_column(spans, records, n, out, valid, ws);
+            }
+            else
+            {
+                for (size_t r = 0; r < n; ++r)
+                {
+                    if (!valid[r]) continue;
+                    valid[r] = convert_field(spans[r], format_c, out[r], arena) ==
+                        std::errc{};
+                }
+            }
+        }
+    };
+}  // namespace stdx::internals
@@ -0,0 +1,304 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "arena.hpp"
+#include "convert.hpp"
+#include "scanner.hpp"
+#include "scan_error.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stdx::internals
+{
+    // Команда скомпилированного формата -- по одной на плейсхолдер
+    struct format_op
+    {
+        uint32_t sep_begin;     // Начало разделителя после плейсхолдера в тексте формата
+        uint32_t sep_size;      // Длина разделителя
+        char spec;              // Форматирующая буква либо '\0'
+    };
+
+    /* Форматирующая строка, известная только во время исполнения
+    (например, из файла конфигурации).  Проверяется тем же
+    count_placeholders, что и format_string, и один раз переводится
+    в таблицу команд: длины текста перед первым и после последнего
+    плейсхолдеров и для каждого плейсхолдера -- разделитель и
+    форматирующая буква.
+    Сканирование по таблице повторяет scanner<format> */
+    class compiled_format
+    {
+    public:
+        [[nodiscard]] constexpr static std::expected<compiled_format, parse_error>
+        compile(std::string_view format)
+        {
+            const std::expected<size_t, parse_error> count =
+                count_placeholders(format);
+            if (!count) return std::unexpected(count.error());
+
+            if (format.size() > std::numeric_limits<uint32_t>::max())
+            {
+                return std::unexpected(parse_error{"Format string is too long"});
+            }
+
+            compiled_format out;
+            out.text = format;
+
+            std::vector<std::pair<size_t, size_t>> positions(*count);
+            find_placeholder_positions(std::string_view{ out.text }, positions.data());
+
+            out.prefix_size = positions.empty() ? 0 : positions.front().first;
+            out.suffix_size = positions.empty()
+                ? out.text.size()
+                : out.text.size() - (positions.back().second + 1);
+            out.min_source_size = out.text.size();
+            out.ops.reserve(positions.size());
+
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                const auto [first, second] = positions[i];
+                out.min_source_size -= second - first + 1;
+
+                /* Текст после последнего плейсхолдера проверяется до
+                разбора полей, поэтому последнее поле тянется до него */
+                const size_t sep_end = (i + 1 < positions.size())
+                    ? positions[i + 1].first
+                    : second + 1;
+
+                out.ops.push_back({
+                    static_cast<uint32_t>(second + 1),
+                    static_cast<uint32_t>(sep_end - (second + 1)),
+                    (second - first > 2) ? out.text[first + 2] : '\0' });
+            }
+
+            return out;
+        }
+
+        constexpr std::string_view str() const { return text; }
+        constexpr size_t n_placeholders() const { return ops.size(); }
+
+        /* Проверка числа и типов значений на соответствие формату.
+        Для format_string это делается static_assert'ами, здесь --
+        во время исполнения */
+        template <typename... Ts>
+        [[nodiscard]] constexpr bool accepts() const
+        {
+            if (sizeof...(Ts) != ops.size()) return false;
+
+            return [&]<size_t... I>(indices<I...>)
+                {
+                    return (... && accepts_specifier<Ts>(ops[I].spec));
+                }(generate_indices<sizeof...(Ts)>{});
+        }
+
+        /* Как и scanner<format>::scan, при несоответствии возвращает
+        scan_error; несоответствие типов формату -- type_mismatch */
+        template <typename... Ts>
+        [[nodiscard]] constexpr std::expected<scan_result<Ts...>, scan_error>
+        scan(std::string_view source, scan_arena* arena = nullptr) const
+        {
+            static_assert((... && is_supported_type_v<Ts>),
+                "Only integral types, float, double and "
+                "std::string_view are accepted; "
+                "references are not permitted");
+            static_assert((... && is_compatible_view_v<Ts, char>),
+                "Only std::string_view is accepted for strings");
+
+            if (!accepts<Ts...>()) [[unlikely]]
+            {
+                return std::unexpected(make_scan_error(
+                    mismatch_reason::type_mismatch, 0, 0));
+            }
+
+            /* Привязка к тексту перед первым и после последнего
+            плейсхолдеров; ошибка указывает на то же место, что и у
+            scanner (anchor_fields) */
+            const std::string_view format_text = text;
+            if (source.size() < min_source_size) [[unlikely]]
+            {
+                return std::unexpected(make_scan_error(
+                    mismatch_reason::literal_mismatch, 0, source.size()));
+            }
+            if (!source.starts_with(format_text.substr(0, prefix_size))) [[unlikely]]
+            {
+                return std::unexpected(make_scan_error(
+                    mismatch_reason::literal_mismatch, 0, 0));
+            }
+            if (!source.ends_with(format_text.substr(text.size() - suffix_size)) ||
+                (ops.empty() && source.size() != text.size())) [[unlikely]]
+            {
+                return std::unexpected(make_scan_error(
+                    mismatch_reason::literal_mismatch,
+                    ops.empty() ? 0 : ops.size() - 1, source.size() - suffix_size));
+            }
+            source.remove_suffix(suffix_size);
+
+            return [&]<size_t... I>(indices<I...>)
+                -> std::expected<scan_result<Ts...>, scan_error>
+            {
+                std::tuple<std::remove_cv_t<Ts>...> values;
+                [[maybe_unused]] size_t pos = prefix_size;
+
+                scan_error error;
+                if (!(... && scan_field(ops[I], I, source, pos,
+                    std::get<I>(values), arena, error))) [[unlikely]]
+                {
+                    return std::unexpected(error);
+                }
+
+                return scan_result<Ts...>{ std::move(std::get<I>(values))... };
+            }(generate_indices<sizeof...(Ts)>{});
+        }
+
+    private:
+        constexpr compiled_format() = default;
+
+        template <typename T>
+        constexpr bool scan_field(const format_op& op, size_t index,
+            std::string_view source, size_t& pos, T& out,
+            scan_arena* arena, scan_error& error) const
+        {
+            const std::string_view sep =
+                std::string_view{ text }.substr(op.sep_begin, op.sep_size);
+
+            const std::expected<field_bounds, mismatch_reason> bounds =
+                find_field(source, pos, sep, index + 1 == ops.size(),
+                    op.spec == 'q');
+            if (!bounds) [[unlikely]]
+            {
+                error = make_scan_error(bounds.error(), index, pos);
+                return false;
+            }
+
+            pos = bounds->next;
+            const std::errc ec = convert_field(
+                source.substr(bounds->begin, bounds->end - bounds->begin),
+                op.spec, out, arena);
+            if (ec != std::errc{}) [[unlikely]]
+            {
+                error = make_scan_error(to_mismatch_reason(ec), index,
+                    bounds->begin);
+                return false;
+            }
+            return true;
+        }
+
+        std::string text;
+        size_t prefix_size = 0;
+        size_t suffix_size = 0;
+        size_t min_source_size = 0;
+        std::vector<format_op> ops;
+    };
+
+    /* Потокобезопасный кэш скомпилированных форматов ограниченного
+    размера с ключом по тексту формата.  Попадание выполняется под
+    разделяемой блокировкой и лишь отмечает запись как используемую;
+    при переполнении вытесняется запись, к которой не обращались
+    с прошлого обхода (алгоритм CLOCK -- приближение LRU без
+    перестановок при каждом попадании) */
+    class format_cache
+    {
+    public:
+        using entry = std::shared_ptr<const compiled_format>;
+
+        constexpr static const size_t DEFAULT_CAPACITY = 256;
+
+        explicit format_cache(size_t capacity = DEFAULT_CAPACITY) :
+            capacity{capacity ? capacity : 1},
+            slots{std::make_unique<slot[]>(this->capacity)}
+        {
+            index.reserve(this->capacity);
+        }
+
+        [[nodiscard]] std::expected<entry, parse_error> get(std::string_view format)
+        {
+            {
+                std::shared_lock lock{mutex};
+                if (const auto it = index.find(format); it != index.end())
+                {
+                    slot& s = slots[it->second];
+                    s.referenced.store(true, std::memory_order_relaxed);
+                    return s.format;
+                }
+            }
+
+            // Компиляция выполняется без блокировки
+            std::expected<compiled_format, parse_error> compiled =
+                compiled_format::compile(format);
+            if (!compiled) return std::unexpected(compiled.error());
+
+            entry out = std::make_shared<const compiled_format>(
+                std::move(*compiled));
+
+            std::unique_lock lock{mutex};
+
+            // Пока формат компилировался, его мог добавить другой поток
+            if (const auto it = index.find(format); it != index.end())
+            {
+                return slots[it->second].format;
+            }
+
+            size_t i = used;
+            if (used < capacity) ++used;
+            else
+            {
+                while (slots[hand].referenced.exchange(false,
+                    std::memory_order_relaxed))
+                {
+                    hand = (hand + 1) % capacity;
+                }
+
+                i = hand;
+                hand = (hand + 1) % capacity;
+                index.erase(slots[i].format->str());
+            }
+
+            slots[i].format = out;
+            slots[i].referenced.store(false, std::memory_order_relaxed);
+            index.emplace(out->str(), i);
+            return out;
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            std::shared_lock lock{mutex};
+            return used;
+        }
+
+        // Общий для программы кэш
+        static format_cache& global()
+        {
+            static format_cache cache;
+            return cache;
+        }
+
+    private:
+        struct slot
+        {
+            entry format;
+            std::atomic<bool> referenced{false};
+        };
+
+        size_t capacity;
+        size_t used = 0;
+        size_t hand = 0;
+        std::unique_ptr<slot[]> slots;
+
+        // Ключи указывают на текст формата внутри записей
+        std::unordered_map<std::string_view, size_t> index;
+        mutable std::shared_mutex mutex;
+    };
+}  // namespace stdx::internals
@@ -0,0 +1,682 @@
+#pragma once
+
+#include "types.hpp"
+#include "arena.hpp"
+#include "quoted.hpp"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace stdx::internals
+{
+    /* Ядра преобразования значений для сканирования во время
+    исполнения.  В отличие от parse_value, работают с произвольным
+    std::basic_string_view и сообщают об ошибке кодом std::errc по примеру
+    std::from_chars: invalid_argument -- неверный формат,
+    result_out_of_range -- значение не помещается в тип.  Все ядра
+    constexpr и могут вычисляться и на этапе компиляции. */
+
+    /* Загрузка 8 байт (8 / sizeof(CharT) кодовых единиц) в порядке
+    little-endian */
+    template <typename CharT>
+    constexpr uint64_t load_u64(const CharT* src)
+    {
+        if !consteval
+        {
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                uint64_t out;
+                std::memcpy(&out, src, sizeof(out));
+                return out;
+            }
+        }
+
+        using Unit = std::make_unsigned_t<CharT>;
+        constexpr size_t width = 8 * sizeof(CharT);
+
+        uint64_t out = 0;
+        for (size_t i = 0; i < 8 / sizeof(CharT); ++i)
+        {
+            out |= static_cast<uint64_t>(static_cast<Unit>(src[i])) << (width * i);
+        }
+        return out;
+    }
+
+    // Проверка, что все 8 байт слова -- цифры (SWAR)
+    constexpr bool is_eight_digits(uint64_t word)
+    {
+        return ((word & 0xF0F0'F0F0'F0F0'F0F0ULL) |
+            (((word + 0x0606'0606'0606'0606ULL) & 0xF0F0'F0F0'F0F0'F0F0ULL) >> 4)) ==
+            0x3333'3333'3333'3333ULL;
+    }
+
+    /* Преобразование 8 цифр за три умножения: цифры складываются
+    попарно, затем четвёрками и, наконец, восьмёркой */
+    constexpr uint32_t parse_eight_digits(uint64_t word)
+    {
+        constexpr uint64_t mask = 0x0000'00FF'0000'00FFULL;
+        constexpr uint64_t mul1 = 100 + (1'000'000ULL << 32);
+        constexpr uint64_t mul2 = 1 + (10'000ULL << 32);
+
+        word -= 0x3030'3030'3030'3030ULL;
+        word = (word * 10) + (word >> 8);
+        word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+        return static_cast<uint32_t>(word);
+    }
+
+    // Проверка, что все 4 двухбайтовые единицы слова -- цифры (SWAR)
+    constexpr bool is_four_digits16(uint64_t word)
+    {
+        return (word & 0xFFF0'FFF0'FFF0'FFF0ULL) == 0x0030'0030'0030'0030ULL &&
+            ((word + 0x0006'0006'0006'0006ULL) & 0x00F0'00F0'00F0'00F0ULL) ==
+            0x0030'0030'0030'0030ULL;
+    }
+
+    // Преобразование 4 двухбайтовых цифр: попарно, затем пары вместе
+    constexpr uint32_t parse_four_digits16(uint64_t word)
+    {
+        word -= 0x0030'0030'0030'0030ULL;
+        word = (word * 10) + (word >> 16);
+        return static_cast<uint32_t>((word & 0xFFFF) * 100 + ((word >> 32) & 0xFFFF));
+    }
+
+    /* Беззнаковый модуль из одних цифр.  Значения больше
+    uint64_t дочитываются до конца для проверки формата.  Блочное
+    ядро выбирается по ширине кодовой единицы: 8 однобайтовых либо
+    4 двухбайтовых цифры за шаг; четырёхбайтовые -- по одной */
+    template <typename CharT>
+    constexpr std::errc convert_digits(const CharT* pos, const CharT* end,
+        uint64_t& out)
+    {
+        if (pos == end) return std::errc::invalid_argument;
+
+        uint64_t value = 0;
+
+        // Восемь цифр за шаг, пока результат гарантированно помещается
+        if constexpr (sizeof(CharT) == 1)
+        {
+            while (end - pos >= 8 && value < 100'000'000'000ULL)
+            {
+                const uint64_t word = load_u64(pos);
+                if (!is_eight_digits(word)) break;
+
+                value = value * 100'000'000ULL + parse_eight_digits(word);
+                pos += 8;
+            }
+        }
+        else if constexpr (sizeof(CharT) == 2)
+        {
+            while (end - pos >= 4 && value < 1'000'000'000'000'000ULL)
+            {
+                const uint64_t word = load_u64(pos);
+                if (!is_four_digits16(word)) break;
+
+                value = value * 10'000ULL + parse_four_digits16(word);
+                pos += 4;
+            }
+        }
+
+        bool overflow = false;
+        for (; pos != end; ++pos)
+        {
+            const uint64_t digit = static_cast<std::make_unsigned_t<CharT>>(*pos - '0');
+            if (digit > 9) return std::errc::invalid_argument;
+
+            if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+            {
+                overflow = true;
+                continue;
+            }
+            value = value * 10 + digit;
+        }
+
+        if (overflow) return std::errc::result_out_of_range;
+
+        out = value;
+        return std::errc{};
+    }
+
+    // Целые числа; как и parse_value, допускается ведущий знак '+'
+    template <typename Int, typename CharT>
+    constexpr std::errc convert_integer(std::basic_string_view<CharT> field,
+        Int& out)
+    {
+        const CharT* pos = field.data();
+        const CharT* end = pos + field.size();
+
+        bool is_negative = false;
+        if (pos != end && (*pos == '-' || *pos == '+'))
+        {
+            is_negative = (*pos++ == '-');
+        }
+
+        uint64_t value = 0;
+        if (const std::errc ec = convert_digits(pos, end, value); ec != std::errc{})
+        {
+            return ec;
+        }
+
+        if constexpr (std::is_signed_v<Int>)
+        {
+            using UInt = std::make_unsigned_t<Int>;
+            const uint64_t limit = static_cast<uint64_t>(
+                std::numeric_limits<Int>::max()) + is_negative;
+            if (value > limit) return std::errc::result_out_of_range;
+
+            out = is_negative
+                ? static_cast<Int>(UInt{0} - static_cast<UInt>(value))
+                : static_cast<Int>(value);
+        }
+        else
+        {
+            if (is_negative && value) return std::errc::result_out_of_range;
+            if (value > std::numeric_limits<Int>::max())
+            {
+                return std::errc::result_out_of_range;
+            }
+
+            out = static_cast<Int>(value);
+        }
+
+        return std::errc{};
+    }
+
+    // Символ мантиссы: цифра или десятичная точка
+    template <typename CharT>
+    constexpr bool is_mantissa_char(const CharT c)
+    {
+        return c == '.' || (c >= '0' && c <= '9');
+    }
+
+    /* Наибольшая длина широкого поля с плавающей точкой: во время
+    исполнения оно сужается в буфер на стеке, более длинные поля
+    отвергаются как invalid_argument (и на этапе компиляции тоже --
+    чтобы результат не зависел от этапа) */
+    inline constexpr size_t max_wide_float_size = 64;
+
+    /* Беззнаковое целое фиксированной ёмкости для точного перевода
+    десятичной записи в двоичную (decimal_to_float).  Ёмкости хватает
+    на 10^1125 -- знаменатель самого длинного значимого поля -- со
+    сдвигом на ширину частного */
+    struct big_uint
+    {
+        static constexpr size_t capacity = 128;
+
+        std::array<uint32_t, capacity> limbs{};
+        size_t size = 0;
+
+        // *this = *this * factor + carry
+        constexpr void multiply(const uint32_t factor, uint32_t carry = 0)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                const uint64_t value = uint64_t(limbs[i]) * factor + carry;
+                limbs[i] = uint32_t(value);
+                carry = uint32_t(value >> 32);
+            }
+            if (carry) limbs[size++] = carry;
+        }
+
+        constexpr void multiply_pow10(uint64_t exp)
+        {
+            for (; exp >= 9; exp -= 9) multiply(1'000'000'000);
+
+            uint32_t factor = 1;
+            for (; exp; --exp) factor *= 10;
+            multiply(factor);
+        }
+
+        constexpr void shift_left(const size_t bits)
+        {
+            const size_t words = bits / 32;
+            const size_t rest = bits % 32;
+            if (!size) return;
+
+            limbs[size + words] = 0;
+            for (size_t i = size; i-- > 0;)
+            {
+                const uint64_t value = uint64_t(limbs[i]) << rest;
+                limbs[i + words + 1] |= uint32_t(value >> 32);
+                limbs[i + words] = uint32_t(value);
+            }
+            for (size_t i = 0; i < words; ++i) limbs[i] = 0;
+
+            size += words + 1;
+            trim();
+        }
+
+        constexpr void shift_right_1()
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                limbs[i] >>= 1;
+                if (i + 1 < size) limbs[i] |= limbs[i + 1] << 31;
+            }
+            trim();
+        }
+
+        // *this -= other, *this >= other
+        constexpr void subtract(const big_uint& other)
+        {
+            uint32_t borrow = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                const uint64_t sub = uint64_t(i < other.size ? other.limbs[i] : 0) + borrow;
+                borrow = limbs[i] < sub;
+                limbs[i] = uint32_t(limbs[i] - sub);
+            }
+            trim();
+        }
+
+        constexpr size_t bit_width() const
+        {
+            return size ? (size - 1) * 32 + std::bit_width(limbs[size - 1]) : 0;
+        }
+
+        constexpr bool operator>=(const big_uint& other) const
+        {
+            if (size != other.size) return size > other.size;
+            for (size_t i = size; i-- > 0;)
+            {
+                if (limbs[i] != other.limbs[i]) return limbs[i] > other.limbs[i];
+            }
+            return true;
+        }
+
+        constexpr void trim()
+        {
+            while (size && !limbs[size - 1]) --size;
+        }
+    };
+
+    /* Отбрасывание того, что parse_value допускает сверх грамматики
+    std::from_chars: завершающих 'f' (1.0f) и 'e' (1.0e) после цифры
+    или точки и ведущего '+' (но не "+-").  false -- поле неверно */
+    template <typename CharT>
+    constexpr bool strip_float_affixes(std::basic_string_view<CharT>& field)
+    {
+        for (const char suffix : { 'f', 'e' })
+        {
+            if (field.size() > 1 &&
+                (field.back() | 0x20) == suffix &&
+                is_mantissa_char(field[field.size() - 2]))
+            {
+                field.remove_suffix(1);
+            }
+        }
+
+        if (!field.empty() && field.front() == '+')
+        {
+            field.remove_prefix(1);
+            if (!field.empty() && field.front() == '-') return false;
+        }
+
+        return !field.empty();
+    }
+
+    /* Перевод десятичной записи в Float с корректным округлением (к
+    ближайшему, при равенстве -- к чётному) без std::from_chars, то
+    есть и на этапе компиляции.  Грамматика и коды ошибок -- как у
+    std::from_chars с chars_format::general на всём поле: inf, infinity
+    и nan без учёта регистра, result_out_of_range при округлении до
+    бесконечности или до нуля.
+
+    Мантиссы до 2^digits со степенью, точно представимой в Float, --
+    быстрый путь Клингера: одно умножение или деление точных чисел.
+    Остальные -- частное D * 10^E / 2^e2 длинной арифметикой с битом
+    остатка для округления.  Больше 800 значащих цифр не нужно:
+    отброшенные ненулевые цифры заменяются одной единицей, которая
+    отделяет значение от середины между соседними Float */
+    template <typename Float, typename CharT>
+    constexpr std::errc decimal_to_float(std::basic_string_view<CharT> field,
+        Float& out)
+    {
+        using limits = std::numeric_limits<Float>;
+        using bits_type = std::conditional_t<sizeof(Float) == 4, uint32_t, uint64_t>;
+        constexpr int P = limits::digits;
+
+        size_t pos = 0;
+        const bool is_negative = !field.empty() && field.front() == '-';
+        pos += is_negative;
+
+        // Бесконечность и NaN
+        const auto equals_word = [&](const size_t at, const std::string_view word)
+            {
+                if (field.size() - at < word.size()) return false;
+                for (size_t i = 0; i < word.size(); ++i)
+                {
+                    if ((field[at + i] | 0x20) != word[i]) return false;
+                }
+                return true;
+            };
+
+        if ((equals_word(pos, "inf") && field.size() == pos + 3) ||
+            (equals_word(pos, "infinity") && field.size() == pos + 8))
+        {
+            out = is_negative ? -limits::infinity() : limits::infinity();
+            return std::errc{};
+        }
+        if (equals_word(pos, "nan"))
+        {
+            bool is_valid = (field.size() == pos + 3);
+            if (field.size() > pos + 4 && field[pos + 3] == '(' && field.back() == ')')
+            {
+                is_valid = true;
+                for (size_t i = pos + 4; i + 1 < field.size(); ++i)
+                {
+                    const CharT c = field[i];
+                    is_valid &= (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' &&
+                        (c | 0x20) <= 'z') || c == '_';
+                }
+            }
+            if (!is_valid) return std::errc::invalid_argument;
+
+            out = limits::quiet_NaN();
+            return std::errc{};
+        }
+
+        // Значащие цифры D и десятичная степень E: значение -- D * 10^E
+        constexpr size_t max_digits = 800;
+        uint8_t digits[max_digits + 1]{};
+        size_t n = 0;
+        size_t n_seen = 0;
+        int64_t exp = 0;
+        bool seen_point = false;
+        bool is_truncated = false;
+
+        for (; pos < field.size(); ++pos)
+        {
+            const CharT c = field[pos];
+            if (c == '.' && !seen_point)
+            {
+                seen_point = true;
+                continue;
+            }
+            if (c < '0' || c > '9') break;
+
+            ++n_seen;
+            if (!n && c == '0')
+            {
+                exp -= seen_point;
+            }
+            else if (n < max_digits)
+            {
+                digits[n++] = uint8_t(c - '0');
+                exp -= seen_point;
+            }
+            else
+            {
+                is_truncated |= (c != '0');
+                exp += !seen_point;
+            }
+        }
+
+        if (!n_seen) return std::errc::invalid_argument;
+
+        if (pos < field.size() && (field[pos] | 0x20) == 'e')
+        {
+            ++pos;
+            const bool is_exp_negative = pos < field.size() && field[pos] == '-';
+            pos += pos < field.size() && (field[pos] == '-' || field[pos] == '+');
+            if (pos == field.size()) return std::errc::invalid_argument;
+
+            // Степень насыщается: за её пределами значение -- 0 или бесконечность
+            int64_t value = 0;
+            for (; pos < field.size(); ++pos)
+            {
+                const CharT c = field[pos];
+                if (c < '0' || c > '9') return std::errc::invalid_argument;
+                if (value < 100'000'000) value = value * 10 + (c - '0');
+            }
+            exp += is_exp_negative ? -value : value;
+        }
+
+        if (pos != field.size()) return std::errc::invalid_argument;
+
+        if (!n)
+        {
+            out = is_negative ? -Float(0) : Float(0);
+            return std::errc{};
+        }
+
+        if (is_truncated)
+        {
+            digits[n++] = 1;
+            --exp;
+        }
+
+        // Значение в [10^(magnitude - 1), 10^magnitude)
+        const int64_t magnitude = int64_t(n) + exp;
+        if (magnitude - 1 > limits::max_exponent10 ||
+            magnitude < limits::min_exponent10 - limits::digits10 - 2)
+        {
+            return std::errc::result_out_of_range;
+        }
+
+        // Быстрый путь Клингера
+        constexpr int64_t max_exact_pow10 = sizeof(Float) == 4 ? 10 : 22;
+        if (n <= 19 && exp >= -max_exact_pow10 && exp <= max_exact_pow10)
+        {
+            uint64_t mantissa = 0;
+            for (size_t i = 0; i < n; ++i) mantissa = mantissa * 10 + digits[i];
+
+            if (mantissa <= (uint64_t(1) << P))
+            {
+                Float scale = 1;
+                for (int64_t i = 0; i < (exp < 0 ? -exp : exp); ++i) scale *= 10;
+
+                const Float value = exp < 0 ? Float(mantissa) / scale
+                    : Float(mantissa) * scale;
+                out = is_negative ? -value : value;
+                return std::errc{};
+            }
+        }
+
+        // Длинная арифметика: частное q = D * 10^E / 2^e2 из [2^P, 2^(P + 2))
+        big_uint num;
+        big_uint den;
+        for (size_t i = 0; i < n; i += 9)
+        {
+            uint32_t chunk = 0;
+            uint32_t scale = 1;
+            for (size_t j = i; j < n && j < i + 9; ++j)
+            {
+                chunk = chunk * 10 + digits[j];
+                scale *= 10;
+            }
+            num.multiply(scale, chunk);
+        }
+        den.multiply(1, 1);
+
+        if (exp >= 0) num.multiply_pow10(uint64_t(exp));
+        else den.multiply_pow10(uint64_t(-exp));
+
+        const int64_t e2 = int64_t(num.bit_width()) - int64_t(den.bit_width()) - P - 1;
+        if (e2 < 0) num.shift_left(size_t(-e2));
+        else den.shift_left(size_t(e2));
+
+        big_uint step = den;
+        step.shift_left(P + 2);
+
+        uint64_t q = 0;
+        for (int i = P + 1; i >= 0; --i)
+        {
+            step.shift_right_1();
+            if (num >= step)
+            {
+                num.subtract(step);
+                q |= uint64_t(1) << i;
+            }
+        }
+        const bool has_remainder = num.size != 0;
+
+        /* Мантисса -- P старших бит частного, для субнормальных чисел --
+        меньше: показатель не опускается ниже min_exponent - digits */
+        constexpr int64_t min_exp2 = limits::min_exponent - P;
+        const int64_t top = int64_t(std::bit_width(q)) - 1;
+        int64_t exp2 = e2 + top - (P - 1);
+        if (exp2 < min_exp2) exp2 = min_exp2;
+
+        const int64_t drop = exp2 - e2;
+        uint64_t mantissa = 0;
+        if (drop < 64)
+        {
+            mantissa = q >> drop;
+            const uint64_t rest = q & ((uint64_t(1) << drop) - 1);
+            const uint64_t half = uint64_t(1) << (drop - 1);
+            mantissa += rest > half ||
+                (rest == half && (has_remainder || (mantissa & 1)));
+        }
+        if (mantissa >> P)
+        {
+            mantissa >>= 1;
+            ++exp2;
+        }
+
+        if (!mantissa ||
+            exp2 + int64_t(std::bit_width(mantissa)) - 1 >= limits::max_exponent)
+        {
+            return std::errc::result_out_of_range;
+        }
+
+        const bits_type fraction = bits_type(mantissa) & ((bits_type(1) << (P - 1)) - 1);
+        const bits_type biased = (mantissa >> (P - 1))
+            ? bits_type(exp2 + (P - 1) + (limits::max_exponent - 1))
+            : 0;
+        out = std::bit_cast<Float>(
+            (bits_type(is_negative) << (sizeof(Float) * 8 - 1)) |
+            (biased << (P - 1)) | fraction);
+        return std::errc{};
+    }
+
+    /* Числа с плавающей точкой.  Как и parse_value, допускаются
+    ведущий '+', завершающая 'f' (1.0f) и пустая степень (1.0e).
+    Во время исполнения используется std::from_chars, на этапе
+    компиляции -- decimal_to_float с тем же результатом.  Широкие
+    кодовые единицы перед std::from_chars сужаются до ASCII в буфер
+    на стеке */
+    template <typename Float, typename CharT>
+    constexpr std::errc convert_float(std::basic_string_view<CharT> field,
+        Float& out)
+    {
+        if constexpr (!std::is_same_v<CharT, char>)
+        {
+            if (field.size() > max_wide_float_size)
+            {
+                return std::errc::invalid_argument;
+            }
+
+            if !consteval
+            {
+                char narrow[max_wide_float_size];
+                for (size_t i = 0; i < field.size(); ++i)
+                {
+                    if (static_cast<std::make_unsigned_t<CharT>>(field[i]) > 0x7f)
+                    {
+                        return std::errc::invalid_argument;
+                    }
+                    narrow[i] = static_cast<char>(field[i]);
+                }
+                return convert_float(std::string_view{ narrow, field.size() }, out);
+            }
+        }
+
+        if (!strip_float_affixes(field)) return std::errc::invalid_argument;
+
+        if constexpr (std::is_same_v<CharT, char>)
+        {
+            if !consteval
+            {
+                const std::from_chars_result result =
+                    std::from_chars(field.data(), field.data() + field.size(), out);
+
+                /* Хвост после числа -- ошибка формата, даже если само
+                число вне диапазона: как у convert_integer и широких
+                кодовых единиц */
+                if (result.ptr != field.data() + field.size())
+                {
+                    return std::errc::invalid_argument;
+                }
+                return result.ec;
+            }
+        }
+
+        return decimal_to_float(field, out);
+    }
+
+    /* Строка %q.  Значение в кавычках возвращается видом на источник,
+    а при наличии экранирования разэкранируется в арену; без арены
+    такое значение считается ошибкой (not_enough_memory) */
+    template <typename CharT>
+    constexpr std::errc convert_quoted(std::basic_string_view<CharT> field,
+        std::basic_string_view<CharT>& out, scan_arena* arena)
+    {
+        if (field.empty() || field.front() != '"')
+        {
+            out = field;
+            return std::errc{};
+        }
+
+        const quoted_span span = find_closing_quote(field, 0);
+        if (span.close != field.size() - 1) return std::errc::invalid_argument;
+
+        const std::basic_string_view<CharT> body = field.substr(1, field.size() - 2);
+        if (!span.has_escapes)
+        {
+            out = body;
+            return std::errc{};
+        }
+
+        if (!arena) return std::errc::not_enough_memory;
+
+        CharT* data = arena->template allocate_units<CharT>(body.size());
+        if (!data) return std::errc::not_enough_memory;
+        out = { data, unescape(body, data) };
+        return std::errc{};
+    }
+
+    // Преобразование поля в значение типа T по форматирующей букве spec
+    template <typename T, typename CharT>
+    constexpr std::errc convert_field(std::basic_string_view<CharT> field,
+        const char spec, T& out, scan_arena* arena)
+    {
+        if constexpr (is_string_view_v<T>)
+        {
+            if (spec == 'q') return convert_quoted(field, out, arena);
+
+            out = field;
+            return std::errc{};
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return convert_float(field, out);
+        }
+        else return convert_integer(field, out);
+    }
+
+    /* Проверка соответствия типа форматирующей букве во время
+    исполнения -- те же правила, что и в format_value */
+    template <typename T>
+    constexpr bool accepts_specifier(const char spec)
+    {
+        using U = std::remove_cv_t<T>;
+        switch (spec)
+        {
+        case '\0': return true;
+        case 'd': return std::is_signed_v<U>;
+        case 'u': return std::is_unsigned_v<U>;
+        case 'f': return std::is_floating_point_v<U>;
+        case 's':
+        case 'q': return is_string_view_v<U>;
+        default: return false;
+        }
+    }
+}  // namespace stdx::internals
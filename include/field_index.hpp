@@ -0,0 +1,477 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "parse.hpp"
+#include "arena.hpp"
+#include "convert.hpp"
+#include "scanner.hpp"
+#include "records.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STDX_SCAN_HAS_MMAP 1
+#endif
+
+namespace stdx::internals
+{
+    /* Хэш содержимого: FNV-1a по 8-байтовым словам, чтобы проверка
+    файла при загрузке индекса стоила меньше поиска разделителей */
+    constexpr uint64_t hash_bytes(std::string_view data)
+    {
+        constexpr uint64_t offset = 0xcbf2'9ce4'8422'2325ULL;
+        constexpr uint64_t prime = 0x0000'0100'0000'01b3ULL;
+
+        uint64_t out = offset ^ data.size();
+        size_t pos = 0;
+        for (; pos + 8 <= data.size(); pos += 8)
+        {
+            out = (out ^ load_u64(data.data() + pos)) * prime;
+        }
+        for (; pos < data.size(); ++pos)
+        {
+            out = (out ^ static_cast<unsigned char>(data[pos])) * prime;
+        }
+        return out ^ (out >> 32);
+    }
+
+    // Беззнаковые целые в формате LEB128: по 7 бит на байт
+    inline void write_varint(std::vector<char>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /* Чтение не дальше end; false, если число не завершено до end
+    либо длиннее 64 бит (повреждённый индекс) */
+    inline bool read_varint(const char*& pos, const char* end, uint64_t& out)
+    {
+        out = 0;
+        for (int shift = 0; shift <= 63 && pos != end; shift += 7)
+        {
+            const auto byte = static_cast<unsigned char>(*pos++);
+            out |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    /* Заголовок файла индекса.  За ним следуют смещения начала записей
+    в файле данных, смещения записей в потоке полей (NO_RECORD для
+    записей, не совпавших с форматом) и сам поток: для каждого
+    плейсхолдера -- расстояние от конца предыдущего поля (для первого --
+    от начала записи) до начала поля и длина поля */
+    struct index_header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t format_hash;
+        uint64_t file_hash;
+        uint64_t file_size;
+        uint64_t n_placeholders;
+        uint64_t n_records;
+        uint64_t data_size;
+    };
+
+    constexpr const char INDEX_MAGIC[4] = { 'S', 'C', 'I', 'X' };
+    // 2: источник привязан к тексту перед первым и после последнего плейсхолдеров
+    constexpr const uint32_t INDEX_VERSION = 2;
+    constexpr const uint64_t NO_RECORD = std::numeric_limits<uint64_t>::max();
+
+    /* Индекс границ полей неизменяемого файла для формата format.
+    Поиск разделителей выполняется один раз при построении; сохранённый
+    рядом с файлом индекс загружается (или отображается в память через
+    mmap) и позволяет сразу переходить к преобразованию значений -- всех
+    или только нужных.  Индекс привязан к хэшам текста формата и
+    содержимого файла и не загружается для другого формата или
+    изменившегося файла.  Записи -- непустые строки, как и в scan_all */
+    template <format_string format>
+    class field_index
+    {
+        static_assert(format.n_placeholders,
+            "The format string has no placeholders to index");
+        static_assert(std::is_same_v<typename decltype(format)::char_type, char>,
+            "Only char format strings can be indexed");
+
+    public:
+        // Построение индекса: один проход поиска разделителей по файлу
+        [[nodiscard]] static field_index build(std::string_view file)
+        {
+            std::vector<uint64_t> lines;
+            std::vector<uint64_t> records;
+            std::vector<char> data;
+
+            for_each_record(file, [&](size_t begin, size_t end)
+                {
+                    const std::string_view line = file.substr(begin, end - begin);
+                    const size_t mark = data.size();
+
+                    const field_region region = anchor_fields<format>(line);
+                    const std::string_view fields = line.substr(0, region.end);
+                    size_t pos = region.begin;
+                    size_t cursor = 0;
+
+                    const bool is_match = (pos != std::string_view::npos) &&
+                        [&]<size_t... I>(indices<I...>)
+                        {
+                            return (... && index_field<I>(fields, pos, cursor, data));
+                        }(generate_indices<format.n_placeholders>{});
+
+                    if (!is_match) data.resize(mark);
+
+                    lines.push_back(begin);
+                    records.push_back(is_match ? mark : NO_RECORD);
+                });
+
+            index_header header{};
+            std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+            header.version = INDEX_VERSION;
+            header.format_hash = get_format_hash();
+            header.file_hash = hash_bytes(file);
+            header.file_size = file.size();
+            header.n_placeholders = format.n_placeholders;
+            header.n_records = lines.size();
+            header.data_size = data.size();
+
+            const size_t size = get_image_size(header);
+            std::shared_ptr<char[]> image{ new char[size] };
+
+            char* out = image.get();
+            out = put(out, &header, sizeof(header));
+            out = put(out, lines.data(), lines.size() * sizeof(uint64_t));
+            out = put(out, records.data(), records.size() * sizeof(uint64_t));
+            put(out, data.data(), data.size());
+
+            return field_index{ file, std::move(image), size };
+        }
+
+        /* Загрузка индекса, сохранённого save() для того же файла.
+        invalid_argument -- индекс построен для другого формата или файла
+        либо повреждён, io_error -- ошибка чтения.  Хэши заголовка
+        относятся к формату и файлу данных, а не к телу индекса, поэтому
+        поток полей каждой записи разбирается при загрузке целиком:
+        обрезанный или испорченный индекс не выводит за пределы ни
+        образа, ни файла */
+        [[nodiscard]] static std::expected<field_index, std::errc>
+        load(const char* path, std::string_view file)
+        {
+            std::expected<std::pair<std::shared_ptr<const char[]>, size_t>,
+                std::errc> image = read_image(path);
+            if (!image) return std::unexpected(image.error());
+
+            auto [data, size] = std::move(*image);
+            if (size < sizeof(index_header)) return std::unexpected(std::errc::invalid_argument);
+
+            index_header header;
+            std::memcpy(&header, data.get(), sizeof(header));
+
+            if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) ||
+                header.version != INDEX_VERSION ||
+                header.format_hash != get_format_hash() ||
+                header.n_placeholders != format.n_placeholders ||
+                header.n_records > size / (2 * sizeof(uint64_t)) ||
+                header.data_size > size ||
+                get_image_size(header) != size ||
+                header.file_size != file.size() ||
+                header.file_hash != hash_bytes(file))
+            {
+                return std::unexpected(std::errc::invalid_argument);
+            }
+
+            field_index out{ file, std::move(data), size };
+            for (size_t i = 0; i < out.n_records; ++i)
+            {
+                const uint64_t offset = out.get_record_offset(i);
+                if (out.get_line_offset(i) > file.size() ||
+                    (offset != NO_RECORD && offset >= header.data_size))
+                {
+                    return std::unexpected(std::errc::invalid_argument);
+                }
+                if (offset == NO_RECORD) continue;
+
+                const char* pos = out.data + offset;
+                size_t end = out.get_line_offset(i);
+                for (size_t j = 0; j < format.n_placeholders; ++j)
+                {
+                    if (!out.next_field(pos, end))
+                    {
+                        return std::unexpected(std::errc::invalid_argument);
+                    }
+                }
+            }
+            return out;
+        }
+
+        // Сохранение индекса в файл
+        [[nodiscard]] std::errc save(const char* path) const
+        {
+            std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+            out.write(image.get(), static_cast<std::streamsize>(image_size));
+            return out ? std::errc{} : std::errc::io_error;
+        }
+
+        // Число записей файла
+        size_t size() const { return n_records; }
+
+        // Совпала ли запись с форматом при построении
+        bool matched(size_t record) const
+        {
+            return get_record_offset(record) != NO_RECORD;
+        }
+
+        // Текст I-го поля записи без поиска разделителей
+        template <size_t I>
+        std::optional<std::string_view> field(size_t record) const
+        {
+            static_assert(I < format.n_placeholders,
+                "The placeholder index is out of range");
+
+            const uint64_t offset = get_record_offset(record);
+            if (offset == NO_RECORD) return std::nullopt;
+
+            const char* pos = data + offset;
+            size_t end = get_line_offset(record);
+            std::optional<std::string_view> out;
+            for (size_t i = 0; i <= I; ++i)
+            {
+                out = next_field(pos, end);
+                if (!out) return std::nullopt;
+            }
+            return out;
+        }
+
+        // Преобразование одного поля записи -- проекция без разбора прочих
+        template <size_t I, typename T>
+        [[nodiscard]] std::optional<T> get(size_t record,
+            scan_arena* arena = nullptr) const
+        {
+            check_type<I, T>();
+
+            const std::optional<std::string_view> text = field<I>(record);
+            if (!text) return std::nullopt;
+
+            std::remove_cv_t<T> out;
+            if (convert_field(*text, get_specifier<I, format>(), out, arena) !=
+                std::errc{})
+            {
+                return std::nullopt;
+            }
+            return out;
+        }
+
+        // Преобразование всех полей записи
+        template <typename... Ts>
+        [[nodiscard]] std::optional<scan_result<Ts...>> scan(size_t record,
+            scan_arena* arena = nullptr) const
+        {
+            static_assert(sizeof...(Ts) == format.n_placeholders,
+                "The number of types does not match the format string");
+
+            const uint64_t offset = get_record_offset(record);
+            if (offset == NO_RECORD) return std::nullopt;
+
+            return [&]<size_t... I>(indices<I...>)
+                -> std::optional<scan_result<Ts...>>
+            {
+                (check_type<I, Ts>(), ...);
+
+                std::tuple<std::remove_cv_t<Ts>...> values;
+                const char* pos = data + offset;
+                size_t end = get_line_offset(record);
+
+                if (!(... && convert_next<I>(pos, end, std::get<I>(values), arena)))
+                {
+                    return std::nullopt;
+                }
+                return scan_result<Ts...>{ std::move(std::get<I>(values))... };
+            }(generate_indices<format.n_placeholders>{});
+        }
+
+    private:
+        field_index(std::string_view file, std::shared_ptr<const char[]> image,
+            size_t image_size) :
+            file{file}, image{std::move(image)}, image_size{image_size}
+        {
+            const char* pos = this->image.get();
+
+            index_header header;
+            std::memcpy(&header, pos, sizeof(header));
+            n_records = header.n_records;
+
+            line_offsets = pos + sizeof(header);
+            record_offsets = line_offsets + n_records * sizeof(uint64_t);
+            data = record_offsets + n_records * sizeof(uint64_t);
+            data_end = data + header.data_size;
+        }
+
+        /* Режим сопоставления входит в хэш: границы полей, найденные
+        точным форматом, не годятся для того же текста с гибкими пробелами */
+        consteval static uint64_t get_format_hash()
+        {
+            return hash_bytes(format.str.sv()) +
+                static_cast<uint64_t>(format.options);
+        }
+
+        static size_t get_image_size(const index_header& header)
+        {
+            return sizeof(header) + 2 * header.n_records * sizeof(uint64_t) +
+                header.data_size;
+        }
+
+        static char* put(char* out, const void* src, size_t size)
+        {
+            if (size) std::memcpy(out, src, size);
+            return out + size;
+        }
+
+        static uint64_t get_u64(const char* base, size_t i)
+        {
+            uint64_t out;
+            std::memcpy(&out, base + i * sizeof(out), sizeof(out));
+            return out;
+        }
+
+        uint64_t get_line_offset(size_t record) const
+        {
+            return get_u64(line_offsets, record);
+        }
+
+        uint64_t get_record_offset(size_t record) const
+        {
+            return (record < n_records) ? get_u64(record_offsets, record) : NO_RECORD;
+        }
+
+        template <size_t I, typename T>
+        constexpr static void check_type()
+        {
+            static_assert(is_supported_type_v<T>,
+                "Only integral types, float, double and "
+                "std::string_view are accepted; "
+                "references are not permitted");
+
+            constexpr char format_c = get_specifier<I, format>();
+            if constexpr (format_c != '\0')
+            {
+                format_value<format_c, T>();
+            }
+        }
+
+        // Поиск границ I-го поля при построении, как в scanner
+        template <size_t I>
+        static bool index_field(std::string_view line, size_t& pos,
+            size_t& cursor, std::vector<char>& data)
+        {
+            const std::expected<field_bounds, mismatch_reason> bounds =
+                find_placeholder_field<I, format_shape<format>{}>(line, pos);
+            if (!bounds) return false;
+
+            write_varint(data, bounds->begin - cursor);
+            write_varint(data, bounds->end - bounds->begin);
+
+            cursor = bounds->end;
+            pos = bounds->next;
+            return true;
+        }
+
+        /* Следующее поле записи: pos -- позиция в потоке полей, end --
+        конец предыдущего поля.  std::nullopt, если поток обрывается или
+        поле выходит за пределы файла */
+        std::optional<std::string_view> next_field(const char*& pos,
+            size_t& end) const
+        {
+            uint64_t gap = 0;
+            uint64_t length = 0;
+            if (!read_varint(pos, data_end, gap) ||
+                !read_varint(pos, data_end, length) ||
+                end > file.size() || gap > file.size() - end ||
+                length > file.size() - end - gap)
+            {
+                return std::nullopt;
+            }
+
+            const size_t begin = end + gap;
+            end = begin + length;
+            return file.substr(begin, length);
+        }
+
+        template <size_t I, typename T>
+        bool convert_next(const char*& pos, size_t& end, T& out,
+            scan_arena* arena) const
+        {
+            const std::optional<std::string_view> text = next_field(pos, end);
+            return text && convert_field(*text, get_specifier<I, format>(),
+                out, arena) == std::errc{};
+        }
+
+        static std::expected<std::pair<std::shared_ptr<const char[]>, size_t>,
+            std::errc> read_image(const char* path)
+        {
+#ifdef STDX_SCAN_HAS_MMAP
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0) return std::unexpected(std::errc::io_error);
+
+            struct stat info;
+            if (::fstat(fd, &info) || info.st_size <= 0)
+            {
+                ::close(fd);
+                return std::unexpected(std::errc::io_error);
+            }
+
+            const size_t size = static_cast<size_t>(info.st_size);
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED) return std::unexpected(std::errc::io_error);
+
+            // Отображение освобождается вместе с последней копией индекса
+            return std::pair{ std::shared_ptr<const char[]>{
+                static_cast<const char*>(mapped),
+                [size](const char* p) { ::munmap(const_cast<char*>(p), size); } },
+                size };
+#else
+            std::ifstream in{ path, std::ios::binary | std::ios::ate };
+            if (!in) return std::unexpected(std::errc::io_error);
+
+            const size_t size = static_cast<size_t>(in.tellg());
+            std::shared_ptr<char[]> out{ new char[size] };
+
+            in.seekg(0);
+            if (!in.read(out.get(), static_cast<std::streamsize>(size)))
+            {
+                return std::unexpected(std::errc::io_error);
+            }
+            return std::pair{ std::shared_ptr<const char[]>{ std::move(out) }, size };
+#endif
+        }
+
+        std::string_view file;
+        std::shared_ptr<const char[]> image;
+        size_t image_size;
+        size_t n_records;
+
+        const char* line_offsets;
+        const char* record_offsets;
+        const char* data;
+        const char* data_end;
+    };
+}  // namespace stdx::internals
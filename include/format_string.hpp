@@ -2,15 +2,35 @@
 
 #include "types.hpp"
 #include <array>
+#include <cstdint>
 #include <expected>
+#include <string_view>
 
 namespace stdx::internals
 {
+    /* Режим сопоставления текста форматирующей строки с источником:
+        exact -- текст совпадает посимвольно;
+        flexible_whitespace -- каждая серия пробельных символов формата
+            совпадает с любой непустой серией пробельных символов
+            источника (пробелы и табуляции выравнивания) */
+    enum class format_options : uint8_t
+    {
+        exact,
+        flexible_whitespace
+    };
+
     // Шаблонный класс для хранения форматирующей строчки и ее особенностей
     // ваш код здесь
-    template <fixed_string fs>
+    template <basic_fixed_string fs,
+        format_options opts = format_options::exact>
     class format_string
     {
+    public:
+        // Кодовая единица форматирующей строки и сканируемых источников
+        using char_type = typename decltype(fs)::value_type;
+
+        constexpr static format_options options = opts;
+
     private:
         /* Функция для получения количества плейсхолдеров и 
         проверки корректности формирующей строки */
@@ -21,7 +41,7 @@ namespace stdx::internals
         consteval static size_t assign_placeholder_count();
 
     public:
-        constexpr static const fixed_string<fs.size + 1>& str = fs;
+        constexpr static const basic_fixed_string<char_type, fs.size + 1>& str = fs;
 
         /* При ошибке обработки попытка положить parse_error в 
         n_placeholders породит ошибку компиляции. */
@@ -38,58 +58,67 @@ namespace stdx::internals
             get_placeholder_positions();
     };
 
-    // Пользовательский литерал
-    template <fixed_string fs>
-    constexpr fixed_string<fs.size + 1> operator""_fs()
+    // Пользовательский литерал; u8"", u"", U"" и L"" тоже допустимы
+    template <basic_fixed_string fs>
+    constexpr auto operator""_fs()
     {
         return fs;
     }
 
-    template <fixed_string fs>
-    consteval std::expected<size_t, parse_error> 
-    format_string<fs>::get_placeholder_count()
+    /* Подсчёт плейсхолдеров и проверка корректности форматирующей
+    строки.  Общая для format_string и compiled_format, поэтому
+    работает как на этапе компиляции, так и во время исполнения.
+    Служебные символы -- ASCII, поэтому строка любых кодовых единиц
+    разбирается одинаково */
+    template <typename CharT>
+    constexpr std::expected<size_t, parse_error>
+    count_placeholders(std::basic_string_view<CharT> str)
     {
-        if constexpr (str.empty()) return 0;
-
         size_t out = 0;
         size_t pos = 0;
 
-        while (pos < str.size)
+        while (pos < str.size())
         {
-            // Пропускаем все символы до '{'
-            if (str.data[pos] != '{')
+            // Закрывающая скобка без открывающей
+            if (str[pos] == '}')
             {
-                ++pos;
-                continue;
+                return std::unexpected(parse_error{"Unmatched closing brace"});
             }
 
-            // Проверка на незакрытость
-            if (pos >= str.size)
+            // Пропускаем все символы до '{'
+            if (str[pos] != '{')
             {
-                return std::unexpected(parse_error{"Missing closing brace"});
+                ++pos;
+                continue;
             }
 
             // Начало плейсхолдера
             ++out;
             ++pos;
 
+            // Проверка незакрытости
+            if (pos >= str.size())
+            {
+                return std::unexpected(parse_error{"Missing closing brace"});
+            }
+
             // Проверка спецификатора формата
-            if (str.data[pos] == '%')
+            if (str[pos] == '%')
             {
                 ++pos;
-                if (pos >= str.size)
+                if (pos >= str.size())
                 {
                     return std::unexpected(parse_error{"Missing closing brace"});
                 }
 
                 // Проверка допустимости спецификатора
-                const char spec = str.data[pos];
-                constexpr char valid_specs[] = {'d', 'u', 'f', 's'};
+                const CharT spec = str[pos];
+                constexpr char valid_specs[] = {'d', 'u', 'f', 's', 'q'};
                 bool valid = false;
 
                 for (const char s : valid_specs)
                 {
-                    if (spec == s)
+                    if (spec == CharT(s))
                     {
                         valid = true;
                         break;
@@ -104,7 +133,7 @@ namespace stdx::internals
             }
 
             // Проверка наличия закрывающей скобки
-            if (pos >= str.size || str.data[pos] != '}')
+            if (pos >= str.size() || str[pos] != '}')
             {
                 return std::unexpected(parse_error{"Missing closing brace"});
             }
@@ -114,31 +143,18 @@ namespace stdx::internals
         return out;
     }
 
-    template <fixed_string fs>
-    consteval size_t format_string<fs>::assign_placeholder_count()
+    /* Запись позиций '{' и '}' плейсхолдеров корректной
+    форматирующей строки в out */
+    template <typename CharT>
+    constexpr void find_placeholder_positions(std::basic_string_view<CharT> str,
+        std::pair<size_t, size_t>* out)
     {
-        constexpr std::expected<size_t, parse_error> out = 
-            get_placeholder_count();
-        
-        static_assert(!!out, 
-            "Error parsing the format string");
-        // static_assert(!!out, 
-        //     ((fixed_string<PARSE_ERR_CAPACITY>*)&out.error())->sv());
-        
-        return *out;
-    }
-
-    template <fixed_string fs>
-    consteval format_string<fs>::PosArray 
-    format_string<fs>::get_placeholder_positions()
-    {
-        PosArray out;
         size_t pos = 0;
         size_t i = 0;
 
-        while (pos < str.size)
+        while (pos < str.size())
         {
-            switch (str.data[pos])
+            switch (str[pos])
             {
             case '{':
                 out[i].first = pos++;
@@ -151,7 +167,36 @@ namespace stdx::internals
                 break;
             }
         }
+    }
+
+    template <basic_fixed_string fs, format_options opts>
+    consteval std::expected<size_t, parse_error> 
+    format_string<fs, opts>::get_placeholder_count()
+    {
+        if constexpr (str.empty()) return 0;
+        else return count_placeholders(str.sv());
+    }
+
+    template <basic_fixed_string fs, format_options opts>
+    consteval size_t format_string<fs, opts>::assign_placeholder_count()
+    {
+        constexpr std::expected<size_t, parse_error> out = 
+            get_placeholder_count();
+        
+        static_assert(!!out, 
+            "Error parsing the format string");
+        // static_assert(!!out, 
+        //     ((fixed_string<PARSE_ERR_CAPACITY>*)&out.error())->sv());
+        
+        return *out;
+    }
 
+    template <basic_fixed_string fs, format_options opts>
+    consteval format_string<fs, opts>::PosArray 
+    format_string<fs, opts>::get_placeholder_positions()
+    {
+        PosArray out;
+        find_placeholder_positions(str.sv(), out.data());
         return out;
     }
 }  // namespace stdx::internals
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "format_string.hpp"
+#include "scan_error.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <x86intrin.h>
+#define STDX_SCAN_HAS_RDTSC 1
+#endif
+
+namespace stdx::internals
+{
+    // Фазы сканирования, для которых замеряются такты
+    enum class scan_phase : uint8_t
+    {
+        separator_search,
+        conversion,
+        count
+    };
+
+    /* Политика инструментирования по умолчанию: все обработчики
+    пусты, и scanner не содержит ни одной лишней инструкции.
+
+    Политика -- класс со статическими членами:
+        enabled, sample_cycles -- включение счётчиков и замеров тактов;
+        read_cycles() -- текущее значение счётчика тактов;
+        on_record<format>(bytes), on_match<format>(),
+        on_mismatch<format>(reason, placeholder),
+        on_phase<format>(phase, cycles) -- обработчики событий */
+    struct no_instrumentation
+    {
+        constexpr static const bool enabled = false;
+        constexpr static const bool sample_cycles = false;
+
+        static uint64_t read_cycles() { return 0; }
+
+        template <format_string format>
+        static void on_record(size_t) {}
+
+        template <format_string format>
+        static void on_match() {}
+
+        template <format_string format>
+        static void on_mismatch(mismatch_reason, size_t) {}
+
+        template <format_string format>
+        static void on_phase(scan_phase, uint64_t) {}
+    };
+
+    // Счётчики одного формата в одном потоке
+    struct scan_counters
+    {
+        uint64_t records = 0;
+        uint64_t matches = 0;
+        uint64_t bytes = 0;
+        std::array<uint64_t, size_t(mismatch_reason::count)> mismatches{};
+        std::array<uint64_t, size_t(scan_phase::count)> cycles{};
+
+        // Число ошибок преобразования по номеру плейсхолдера
+        std::vector<uint64_t> conversion_failures;
+
+        uint64_t mismatch_count(const mismatch_reason reason) const
+        {
+            return mismatches[size_t(reason)];
+        }
+
+        uint64_t phase_cycles(const scan_phase phase) const
+        {
+            return cycles[size_t(phase)];
+        }
+    };
+
+    /* Политика, подсчитывающая записи, совпадения, несовпадения по
+    причинам, байты и ошибки преобразования по плейсхолдерам, а при
+    sample_cycles -- ещё и такты (rdtsc, на прочих архитектурах --
+    наносекунды steady_clock) по фазам.
+
+    Счётчики хранятся в thread_local-таблице потока с ключом по тексту
+    формата format_string<fs>::str, поэтому обновление и чтение не
+    требуют ни блокировок, ни атомарных операций.  Снимок отражает
+    только текущий поток */
+    template <bool sample = false>
+    struct counting_instrumentation
+    {
+        constexpr static const bool enabled = true;
+        constexpr static const bool sample_cycles = sample;
+
+        static uint64_t read_cycles()
+        {
+#ifdef STDX_SCAN_HAS_RDTSC
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        template <format_string format>
+        static void on_record(const size_t bytes)
+        {
+            scan_counters& c = counters<format>();
+            ++c.records;
+            c.bytes += bytes;
+        }
+
+        template <format_string format>
+        static void on_match()
+        {
+            ++counters<format>().matches;
+        }
+
+        template <format_string format>
+        static void on_mismatch(const mismatch_reason reason,
+            const size_t placeholder)
+        {
+            scan_counters& c = counters<format>();
+            ++c.mismatches[size_t(reason)];
+            if (reason != mismatch_reason::unclosed_quote &&
+                reason != mismatch_reason::literal_mismatch)
+            {
+                ++c.conversion_failures[placeholder];
+            }
+        }
+
+        template <format_string format>
+        static void on_phase(const scan_phase phase, const uint64_t cycles)
+        {
+            counters<format>().cycles[size_t(phase)] += cycles;
+        }
+
+        // Копия счётчиков формата в текущем потоке
+        static std::optional<scan_counters> snapshot(std::string_view format)
+        {
+            const auto it = registry().find(format);
+            if (it == registry().end()) return std::nullopt;
+            return it->second;
+        }
+
+        template <format_string format>
+        static std::optional<scan_counters> snapshot()
+        {
+            return snapshot(text<format>());
+        }
+
+        // Обнуление счётчиков всех форматов текущего потока
+        static void reset()
+        {
+            for (auto& [format, c] : registry())
+            {
+                c = scan_counters{ .conversion_failures =
+                    std::vector<uint64_t>(c.conversion_failures.size()) };
+            }
+        }
+
+    private:
+        /* Ключ -- байты текста формата, поэтому форматы из широких
+        кодовых единиц тоже различаются */
+        template <format_string format>
+        static std::string_view text()
+        {
+            return { reinterpret_cast<const char*>(format.str.data),
+                format.str.size * sizeof(format.str.data[0]) };
+        }
+
+        // Элементы unordered_map не перемещаются при перехешировании
+        static std::unordered_map<std::string_view, scan_counters>& registry()
+        {
+            thread_local std::unordered_map<std::string_view, scan_counters> out;
+            return out;
+        }
+
+        // Поиск в таблице -- один раз на формат и поток
+        template <format_string format>
+        static scan_counters& counters()
+        {
+            thread_local scan_counters& out = registry().try_emplace(
+                text<format>(), scan_counters{ .conversion_failures =
+                    std::vector<uint64_t>(format.n_placeholders) }).first->second;
+            return out;
+        }
+    };
+}  // namespace stdx::internals
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stdx::internals
+{
+    /* Вид на строку, сжатый до смещения и длины относительно базы
+    пакета -- источника, в котором лежат значения записей */
+    struct packed_view
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    // Тип, в котором поле хранится в упакованной записи
+    template <typename T>
+    using packed_type_t = std::conditional_t<is_string_view_v<std::remove_cv_t<T>>,
+        packed_view, std::remove_cv_t<T>>;
+
+    // Кодовая единица видов на строки записи; char, если видов нет
+    template <typename... Ts>
+    struct record_char
+    {
+        using type = char;
+    };
+
+    template <typename T, typename... Ts>
+    struct record_char<T, Ts...> : record_char<Ts...>
+    {};
+
+    template <typename CharT, typename... Ts>
+    struct record_char<std::basic_string_view<CharT>, Ts...>
+    {
+        using type = CharT;
+    };
+
+    template <typename CharT, typename... Ts>
+    struct record_char<const std::basic_string_view<CharT>, Ts...>
+    {
+        using type = CharT;
+    };
+
+    /* Порядок хранения полей: номера плейсхолдеров по убыванию
+    выравнивания хранимых типов, при равенстве -- в исходном порядке.
+    Размеры кратны выравниванию, поэтому поля идут без промежутков */
+    template <typename... Ts>
+    consteval std::array<size_t, sizeof...(Ts)> get_packed_order()
+    {
+        const std::array<size_t, sizeof...(Ts)> aligns{ alignof(packed_type_t<Ts>)... };
+
+        std::array<size_t, sizeof...(Ts)> out{};
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            // Вставка с сохранением порядка равных
+            size_t j = i;
+            while (j && aligns[out[j - 1]] < aligns[i])
+            {
+                out[j] = out[j - 1];
+                --j;
+            }
+            out[j] = i;
+        }
+        return out;
+    }
+
+    // Место I-го плейсхолдера в порядке хранения
+    template <size_t I, typename... Ts>
+    consteval size_t get_packed_slot()
+    {
+        constexpr std::array<size_t, sizeof...(Ts)> order = get_packed_order<Ts...>();
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            if (order[k] == I) return k;
+        }
+        return order.size();
+    }
+
+    /* Поля в порядке объявления: голова, затем хвост.  Пустой хвост
+    места не занимает */
+    template <typename... Ts>
+    struct packed_fields
+    {};
+
+    template <typename T, typename... Ts>
+    struct packed_fields<T, Ts...>
+    {
+        T head{};
+        [[no_unique_address]] packed_fields<Ts...> tail;
+    };
+
+    template <size_t K, typename T, typename... Ts>
+    constexpr auto& get_field(packed_fields<T, Ts...>& fields)
+    {
+        if constexpr (!K) return fields.head;
+        else return get_field<K - 1>(fields.tail);
+    }
+
+    template <size_t K, typename T, typename... Ts>
+    constexpr const auto& get_field(const packed_fields<T, Ts...>& fields)
+    {
+        if constexpr (!K) return fields.head;
+        else return get_field<K - 1>(fields.tail);
+    }
+
+    // Поля, переставленные в порядок хранения
+    template <typename Order, typename... Ts>
+    struct packed_layout;
+
+    template <size_t... K, typename... Ts>
+    struct packed_layout<std::index_sequence<K...>, Ts...>
+    {
+        using type = packed_fields<packed_type_t<std::tuple_element_t<
+            get_packed_order<Ts...>()[K], std::tuple<Ts...>>>...>;
+    };
+
+    /* Запись результата сканирования для долгого хранения: поля
+    переставлены по убыванию выравнивания, а виды на строки сжаты до
+    32-битных смещения и длины относительно базы пакета.  get<I>
+    по-прежнему нумерует поля в порядке плейсхолдеров; видам на строки
+    нужна та же база, что и при упаковке, и без неё они не читаются */
+    template <typename... Ts>
+    class packed_record
+    {
+        static_assert((... && is_supported_type_v<Ts>),
+            "Only integral types, float, double and "
+            "std::basic_string_view are accepted; "
+            "references are not permitted");
+
+    public:
+        using char_type = typename record_char<Ts...>::type;
+        using view_type = std::basic_string_view<char_type>;
+
+        static_assert((... && is_compatible_view_v<Ts, char_type>),
+            "String views of a record must share the character type");
+
+        constexpr packed_record() = default;
+
+        // I-е поле -- вид на строку и читается только с базой пакета
+        template <size_t I>
+        consteval static bool is_view_field()
+        {
+            if constexpr (I < sizeof...(Ts))
+            {
+                return is_string_view_v<std::remove_cv_t<
+                    std::tuple_element_t<I, std::tuple<Ts...>>>>;
+            }
+            else return false;
+        }
+
+        /* Упаковка результата.  std::nullopt, если вид на строку не
+        лежит внутри base (например, разэкранирован в scan_arena) либо
+        его смещение не умещается в 32 бита */
+        [[nodiscard]] constexpr static std::optional<packed_record>
+        pack(const scan_result<Ts...>& result, const view_type base)
+        {
+            packed_record out;
+            const bool ok = [&]<size_t... I>(std::index_sequence<I...>)
+                {
+                    return (... && out.template put<I>(std::get<I>(result.values), base));
+                }(std::index_sequence_for<Ts...>{});
+
+            if (!ok) return std::nullopt;
+            return out;
+        }
+
+        /* Значение I-го плейсхолдера; base -- база пакета при упаковке.
+        Без базы вид на строку не восстановить, поэтому она обязательна */
+        template <size_t I>
+        [[nodiscard]] constexpr auto get(const view_type base) const
+        {
+            static_assert(I < sizeof...(Ts), "Invalid placeholder index");
+
+            const auto& field = get_field<get_packed_slot<I, Ts...>()>(fields);
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(field)>, packed_view>)
+            {
+                return view_type{ base.data() + field.offset, field.size };
+            }
+            else return field;
+        }
+
+        // Значение I-го плейсхолдера, если это не вид на строку
+        template <size_t I>
+            requires (!is_view_field<I>())
+        [[nodiscard]] constexpr auto get() const
+        {
+            static_assert(I < sizeof...(Ts), "Invalid placeholder index");
+
+            return get_field<get_packed_slot<I, Ts...>()>(fields);
+        }
+
+        // Обратная распаковка в scan_result
+        [[nodiscard]] constexpr scan_result<Ts...> unpack(const view_type base) const
+        {
+            return [&]<size_t... I>(std::index_sequence<I...>)
+                {
+                    return scan_result<Ts...>{ get<I>(base)... };
+                }(std::index_sequence_for<Ts...>{});
+        }
+
+        // Распаковка записи без видов на строки
+        [[nodiscard]] constexpr scan_result<Ts...> unpack() const
+            requires (!(... || is_string_view_v<std::remove_cv_t<Ts>>))
+        {
+            return [&]<size_t... I>(std::index_sequence<I...>)
+                {
+                    return scan_result<Ts...>{ get<I>()... };
+                }(std::index_sequence_for<Ts...>{});
+        }
+
+    private:
+        template <size_t I, typename T>
+        constexpr bool put(const T& value, const view_type base)
+        {
+            auto& field = get_field<get_packed_slot<I, Ts...>()>(fields);
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(field)>, packed_view>)
+            {
+                if (value.empty()) return true;
+
+                /* std::less задаёт полный порядок и на указателях в разные
+                объекты, поэтому вид вне base отсекается без UB */
+                const std::less<const char_type*> less;
+                if (less(value.data(), base.data()) ||
+                    less(base.data() + base.size(), value.data() + value.size()))
+                {
+                    return false;
+                }
+
+                const size_t offset = size_t(value.data() - base.data());
+                if (offset > UINT32_MAX || value.size() > UINT32_MAX) return false;
+
+                field = packed_view{ uint32_t(offset), uint32_t(value.size()) };
+            }
+            else field = value;
+            return true;
+        }
+
+        typename packed_layout<std::index_sequence_for<Ts...>, Ts...>::type fields;
+    };
+}  // namespace stdx::internals
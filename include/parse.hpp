@@ -2,16 +2,175 @@
 
 #include "types.hpp"
 #include "format_string.hpp"
+#include "convert.hpp"
+#include "quoted.hpp"
+#include "search.hpp"
 
 #include <cstdint>
 #include <string_view>
+#include <system_error>
 #include <utility>
 
 namespace stdx::internals
 {
+    /* Форматирующая буква I-го плейсхолдера либо '\0',
+    если плейсхолдер задан как {}.  Буквы -- ASCII, поэтому для
+    строк любых кодовых единиц возвращается char */
+    template <size_t I, format_string format>
+    consteval char get_specifier()
+    {
+        constexpr std::pair<size_t, size_t> format_pos =
+            format.placeholder_positions[I];
+
+        if constexpr (format_pos.second - format_pos.first > 2)
+        {
+            return static_cast<char>(format.str.data[format_pos.first + 2]);
+        }
+        else return '\0';
+    }
+
+    // Границы текста между (I-1)-ым и I-ым плейсхолдерами
+    template <size_t I, format_string format>
+    consteval std::pair<size_t, size_t> get_literal_before()
+    {
+        const size_t begin = I
+            ? format.placeholder_positions[I - 1].second + 1
+            : 0;
+        return { begin, format.placeholder_positions[I].first - begin };
+    }
+
+    // Границы текста после последнего плейсхолдера
+    template <format_string format>
+    consteval std::pair<size_t, size_t> get_literal_after()
+    {
+        if constexpr (!format.n_placeholders) return { 0, format.str.size };
+        else
+        {
+            const size_t begin =
+                format.placeholder_positions[format.n_placeholders - 1].second + 1;
+            return { begin, format.str.size - begin };
+        }
+    }
+
+    /* Границы разделителя после I-го плейсхолдера: текст до
+    следующего плейсхолдера либо до конца форматирующей строки */
+    template <size_t I, format_string format>
+    consteval std::pair<size_t, size_t> get_separator_after()
+    {
+        if constexpr (I + 1 < format.n_placeholders)
+        {
+            return get_literal_before<I + 1, format>();
+        }
+        else return get_literal_after<format>();
+    }
+
+    // Суммарная длина текста форматирующей строки вне плейсхолдеров
+    template <format_string format>
+    consteval size_t get_literal_size()
+    {
+        size_t out = format.str.size;
+        for (const std::pair<size_t, size_t>& pos : format.placeholder_positions)
+        {
+            out -= pos.second - pos.first + 1;
+        }
+        return out;
+    }
+
+    /* Требует ли литерал формата (начало, длина) гибкого сопоставления:
+    только в режиме flexible_whitespace и только при наличии в нём
+    пробельных символов.  Прочие литералы ищутся точно и быстро */
+    template <format_string format>
+    consteval bool is_flexible_literal(const std::pair<size_t, size_t> literal)
+    {
+        if constexpr (format.options != format_options::flexible_whitespace)
+        {
+            return false;
+        }
+        else
+        {
+            for (size_t i = 0; i < literal.second; ++i)
+            {
+                if (is_space(format.str.data[literal.first + i])) return true;
+            }
+            return false;
+        }
+    }
+
+    /* Наименьшая длина источника, совпадающего с форматом: сумма длин
+    литералов, причём серия пробелов гибкого литерала требует лишь
+    одного пробельного символа.  Более короткие строки отвергаются
+    до поиска полей */
+    template <format_string format>
+    consteval size_t get_min_source_size()
+    {
+        const auto literal_size = [](const std::pair<size_t, size_t> literal) consteval
+            {
+                if (!is_flexible_literal<format>(literal)) return literal.second;
+
+                size_t out = 0;
+                for (size_t i = 0; i < literal.second; ++i)
+                {
+                    const bool space = is_space(format.str.data[literal.first + i]);
+                    if (!space || !i || !is_space(format.str.data[literal.first + i - 1])) ++out;
+                }
+                return out;
+            };
+
+        size_t out = literal_size(get_literal_after<format>());
+        [&]<size_t... I>(indices<I...>)
+        {
+            (..., (out += literal_size(get_literal_before<I, format>())));
+        }(generate_indices<format.n_placeholders>{});
+        return out;
+    }
+
+    /* Поиск литерала формата (начало first, длина size) в источнике
+    начиная с from: точно либо с гибкими пробелами */
+    template <format_string format, size_t first, size_t size,
+        typename CharT>
+    constexpr literal_match find_literal(std::basic_string_view<CharT> source,
+        const size_t from)
+    {
+        constexpr std::basic_string_view<CharT> text{
+            format.str.data + first, size };
+
+        if constexpr (is_flexible_literal<format>({ first, size }))
+        {
+            return find_flexible(source, text, from);
+        }
+        else
+        {
+            const size_t pos = find_separator(source, text, from);
+            if (pos == std::string_view::npos) return {};
+            return { pos, pos + size };
+        }
+    }
+
+    /* Позиция, с которой ищется разделитель после I-го плейсхолдера.
+    Для %q в кавычках -- сразу за закрывающей кавычкой, чтобы
+    разделитель внутри кавычек не обрывал значение */
+    template <size_t I, format_string format, basic_fixed_string source,
+        size_t src_start>
+    consteval size_t get_separator_search_start()
+    {
+        if constexpr (get_specifier<I, format>() != 'q' ||
+            src_start >= source.size || source.data[src_start] != '"')
+        {
+            return src_start;
+        }
+        else
+        {
+            constexpr quoted_span span =
+                find_closing_quote(source.sv(), src_start);
+            static_assert(span.close != std::string_view::npos,
+                "Missing closing quote");
+            return span.close + 1;
+        }
+    }
+
     /* Шаблонная функция, возвращающая пару позиций в
     строке с исходными данными, соотвествующих I-ому плейсхолдеру */
-    template<size_t I, format_string format, fixed_string source>
+    template<size_t I, format_string format, basic_fixed_string source>
     consteval std::pair<size_t, size_t> get_parsing_boundaries()
     {
         static_assert(I < format.n_placeholders,
@@ -25,7 +184,26 @@ namespace stdx::internals
         constexpr size_t src_start =
             [&]()
             {
-                if constexpr (!I) return fmt_start;
+                /* Источник привязан к формату с обоих концов: текст перед
+                первым плейсхолдером должен совпадать с началом источника,
+                а длина источника -- быть не меньше суммы литералов */
+                if constexpr (!I)
+                {
+                    static_assert(source.size >= get_min_source_size<format>(),
+                        "The source is shorter than the format string requires");
+
+                    constexpr size_t prefix_end =
+                        is_flexible_literal<format>({ 0, fmt_start })
+                        ? match_flexible(source.sv(),
+                            format.str.sv().substr(0, fmt_start), 0)
+                        : source.sv().starts_with(format.str.sv().substr(0, fmt_start))
+                            ? fmt_start
+                            : std::string_view::npos;
+                    static_assert(prefix_end != std::string_view::npos,
+                        "The source does not match the text before "
+                        "the first placeholder");
+                    return prefix_end;
+                }
                 else
                 {
                     // Находим конец предыдущего плейсхолдера в исходной строке
@@ -37,14 +215,11 @@ namespace stdx::internals
                     constexpr size_t prev_fmt_end =
                         format.placeholder_positions[I - 1].second;
 
-                    constexpr std::string_view sep =
-                        format.str.sv().substr(prev_fmt_end + 1, fmt_start - (prev_fmt_end + 1));
-
                     // Ищем разделитель после предыдущего значения
-                    constexpr size_t pos = source.sv().find(sep, prev_end);
-                    return (pos != std::string_view::npos)
-                        ? pos + sep.size()
-                        : source.size;
+                    constexpr literal_match match = find_literal<format,
+                        prev_fmt_end + 1, fmt_start - (prev_fmt_end + 1)>(
+                            source.sv(), prev_end);
+                    return match.end;
                 }
             }();
 
@@ -57,16 +232,41 @@ namespace stdx::internals
                 {
                     return source.size;
                 }
-
-                constexpr std::string_view sep =
-                    format.str.sv().substr(fmt_end + 1,
-                        (I < format.n_placeholders - 1)
-                        ? format.placeholder_positions[I + 1].first - (fmt_end + 1)
-                        : format.str.size - (fmt_end + 1));
-
-                // Ищем разделитель после текущего значения
-                constexpr auto pos = source.sv().find(sep, src_start);
-                return (pos != std::string_view::npos) ? pos : source.size;
+                else if constexpr (I + 1 == format.n_placeholders)
+                {
+                    // Текст после последнего плейсхолдера -- конец источника
+                    constexpr std::pair<size_t, size_t> suffix =
+                        get_literal_after<format>();
+                    constexpr std::basic_string_view text =
+                        format.str.sv().substr(suffix.first, suffix.second);
+
+                    constexpr size_t suffix_begin =
+                        is_flexible_literal<format>(suffix)
+                        ? match_flexible_back(source.sv(), text, src_start)
+                        : source.size >= src_start + text.size() &&
+                            source.sv().ends_with(text)
+                            ? source.size - text.size()
+                            : std::string_view::npos;
+                    static_assert(suffix_begin != std::string_view::npos,
+                        "The source does not match the text after "
+                        "the last placeholder");
+                    return suffix_begin;
+                }
+                else
+                {
+                    constexpr size_t sep_size =
+                        format.placeholder_positions[I + 1].first - (fmt_end + 1);
+
+                    // Ищем разделитель после текущего значения
+                    constexpr size_t search_start =
+                        get_separator_search_start<I, format, source, src_start>();
+                    constexpr literal_match match =
+                        find_literal<format, fmt_end + 1, sep_size>(
+                            source.sv(), search_start);
+                    static_assert(match.begin != std::string_view::npos,
+                        "Separator not found in the source");
+                    return match.begin;
+                }
             }();
         return std::pair{ src_start, src_end };
     }
@@ -75,7 +275,7 @@ namespace stdx::internals
     /* Попадание сюда возможно, только если
     требуемый тип -- не (u)int, не double и
     не string_view */
-    template <fixed_string fs, typename T, typename>
+    template <basic_fixed_string fs, typename T, typename>
     consteval T parse_value()
     {
         static_assert(false, "Unsupported type -- "
@@ -84,7 +284,7 @@ namespace stdx::internals
     }
 
     /* Случай строго int */
-    template <fixed_string fs, typename Int,
+    template <basic_fixed_string fs, typename Int,
         std::enable_if_t<std::is_same_v<Int, int>>* = nullptr>
     consteval int parse_value()
     {
@@ -96,7 +296,7 @@ namespace stdx::internals
 
         if constexpr (std::find_if(fs.sv().begin() + is_signed,
             fs.sv().end(),
-            [](const char digit)
+            [](const auto digit)
             {
                 return digit < '0' || digit > '9';
             }) != fs.sv().end()) static_assert(false, "Invalid number format");
@@ -112,7 +312,7 @@ namespace stdx::internals
     }
 
     /* Случай прочих целочисленных типов */
-    template <fixed_string fs, typename IntType,
+    template <basic_fixed_string fs, typename IntType,
         std::enable_if_t<!std::is_same_v<IntType, int> &&
         std::is_integral_v<IntType>>* = nullptr>
     consteval IntType parse_value()
@@ -164,12 +364,13 @@ namespace stdx::internals
         return (IntType)out;
     }
 
-    /* Случай double */
-    template <fixed_string fs, typename Double,
-        std::enable_if_t<std::is_same_v<Double, double>>* = nullptr>
-    consteval double parse_value()
+    /* Проверка записи числа с плавающей точкой: целая и дробная части
+    и степень -- целые, точка одна и стоит до степени.  Нарушение --
+    ошибка компиляции */
+    template <basic_fixed_string fs>
+    consteval void check_float_format()
     {
-        if constexpr (!fs.size) return 0;
+        using CharT = typename decltype(fs)::value_type;
 
         /* Исключаем из рассмотрения завершающую f (например, 1.0f)
         в случае её наличия */
@@ -177,20 +378,14 @@ namespace stdx::internals
             ? fs.size - 1
             : fs.size;
 
-        int whole = 0;
-        int frac = 0;
-        int exp = 0;
-
-        double frac_scale = 1;
-        double factor = 1;
-
         constexpr size_t point_pos = fs.sv().find_first_of('.');
-        constexpr size_t exp_pos = fs.sv().find_first_of("eE");
+        constexpr CharT exp_chars[] = { 'e', 'E' };
+        constexpr size_t exp_pos = fs.sv().find_first_of(exp_chars, 0, 2);
 
         // Исключаем повторяющиеся точки и е
         if constexpr (fs.sv().find_first_of('.', point_pos + 1) !=
             std::string_view::npos) static_assert(false, "Invalid number format");
-        if constexpr (fs.sv().find_first_of("eE", exp_pos + 1) !=
+        if constexpr (fs.sv().find_first_of(exp_chars, exp_pos + 1, 2) !=
             std::string_view::npos) static_assert(false, "Invalid number format");
 
         // Показатель степени не может быть дробным 123е1.23
@@ -200,17 +395,14 @@ namespace stdx::internals
             static_assert(false, "Invalid number format");
         }
 
-        // Знак
-        constexpr bool is_negative = fs.data[0] == '-';
-
         // Целая часть
         constexpr size_t whole_capacity =
             ((size < point_pos)
                 ? ((size < exp_pos) ? size : exp_pos)
                 : point_pos) + 1;
-        constexpr fixed_string<whole_capacity>
+        constexpr basic_fixed_string<CharT, whole_capacity>
             whole_fs{ fs.data, fs.data + whole_capacity - 1 };
-        whole = parse_value<whole_fs, int>();
+        parse_value<whole_fs, int>();
 
         // Дробная часть
         if constexpr (point_pos < size)
@@ -223,55 +415,130 @@ namespace stdx::internals
 
             constexpr size_t frac_capacity =
                 ((size < exp_pos) ? size : exp_pos) - point_pos;
-            constexpr fixed_string<frac_capacity>
+            constexpr basic_fixed_string<CharT, frac_capacity>
                 frac_fs{ &fs.data[point_pos + 1],
                     &fs.data[point_pos + frac_capacity] };
-            frac = parse_value<frac_fs, int>();
-
-            for (size_t i = 0; i < frac_capacity - 1; ++i)
-            {
-                frac_scale *= 10;
-            }
+            parse_value<frac_fs, int>();
         }
 
         // Степень
         if constexpr (exp_pos < size)
         {
             constexpr size_t exp_capacity = size - exp_pos;
-            constexpr fixed_string<exp_capacity>
+            constexpr basic_fixed_string<CharT, exp_capacity>
                 exp_fs{ &fs.data[exp_pos + 1],
                     &fs.data[exp_pos + exp_capacity] };
-            exp = parse_value<exp_fs, int>();
+            parse_value<exp_fs, int>();
+        }
+    }
+
+    /* Не constexpr: её вызов при вычислении parse_value -- ошибка
+    компиляции для числа, которое не помещается в тип */
+    inline void float_value_out_of_range() {}
+
+    /* Значение проверенной записи -- decimal_to_float, то есть с тем
+    же корректным округлением, что и std::from_chars во время
+    исполнения */
+    template <basic_fixed_string fs, typename Float>
+    consteval Float parse_float()
+    {
+        if constexpr (!fs.size) return 0;
+        else
+        {
+            check_float_format<fs>();
 
-            for (size_t i = 0; i < ((exp >= 0) ? exp : -exp); ++i)
+            std::basic_string_view<typename decltype(fs)::value_type> text = fs.sv();
+            Float out = 0;
+            if (!strip_float_affixes(text) ||
+                decimal_to_float(text, out) != std::errc{})
             {
-                factor *= 10;
+                float_value_out_of_range();
             }
+            return out;
         }
+    }
 
-        double out = (exp > 0)
-            ? whole * factor + (is_negative ? -1 : 1) * frac / (frac_scale / factor)
-            : whole / factor + (is_negative ? -1 : 1) * frac / (frac_scale * factor);
-        return out;
+    /* Случай double */
+    template <basic_fixed_string fs, typename Double,
+        std::enable_if_t<std::is_same_v<Double, double>>* = nullptr>
+    consteval double parse_value()
+    {
+        return parse_float<fs, double>();
     }
 
     /* Случай float */
-    template <fixed_string fs, typename Float,
+    template <basic_fixed_string fs, typename Float,
         std::enable_if_t<std::is_same_v<Float, float>>* = nullptr>
     consteval float parse_value()
     {
-        return (float)parse_value<fs, double>();
+        return parse_float<fs, float>();
     }
 
     /* Случай string_view.  Ответ с expected для
     единообразности с другими специализациями */
-    template <fixed_string fs, typename StringView,
-        std::enable_if_t<std::is_same_v<StringView, std::string_view>>* = nullptr>
-    consteval std::string_view parse_value() noexcept
+    template <basic_fixed_string fs, typename StringView,
+        std::enable_if_t<std::is_same_v<StringView,
+            std::basic_string_view<typename decltype(fs)::value_type>>>* = nullptr>
+    consteval StringView parse_value() noexcept
     {
         return fs.sv();
     }
 
+    /* Хранилище разэкранированной строки.  Статический член шаблона
+    живёт всё время работы программы, поэтому string_view на него
+    остаётся константным выражением */
+    template <basic_fixed_string body>
+    struct unescaped_storage
+    {
+        using CharT = typename decltype(body)::value_type;
+
+        constexpr static size_t size =
+            []()
+            {
+                CharT buffer[body.size + 1]{};
+                return unescape(body.sv(), buffer);
+            }();
+
+        constexpr static basic_fixed_string<CharT, size + 1> value =
+            []()
+            {
+                CharT buffer[body.size + 1]{};
+                unescape(body.sv(), buffer);
+                return basic_fixed_string<CharT, size + 1>{ buffer, buffer + size };
+            }();
+    };
+
+    /* Случай %q: значение в кавычках возвращается без копирования,
+    разэкранирование выполняется, только если в нём встречаются слэши.
+    Значение без кавычек обрабатывается как %s */
+    template <basic_fixed_string source, size_t first, size_t last>
+    consteval auto parse_quoted()
+    {
+        constexpr auto field = source.sv().substr(first, last - first);
+
+        if constexpr (field.empty() || field.front() != '"')
+        {
+            return field;
+        }
+        else
+        {
+            constexpr quoted_span span = find_closing_quote(field, 0);
+            static_assert(span.close == field.size() - 1,
+                "Unexpected text after closing quote");
+
+            constexpr auto body = field.substr(1, field.size() - 2);
+
+            if constexpr (!span.has_escapes) return body;
+            else
+            {
+                constexpr basic_fixed_string<
+                    typename decltype(source)::value_type, body.size() + 1>
+                    body_fs{ body.data(), body.data() + body.size() };
+                return unescaped_storage<body_fs>::value.sv();
+            }
+        }
+    }
+
     //=== Форматировщики данных ===
     /* Попадание сюда возможно, только если
     форматирующая буква не соответствует типу */
@@ -281,7 +548,7 @@ namespace stdx::internals
         static_assert(false, "Type-format mismatch: "
             "%d for integer types, "
             "%u for unsigned integer types, "
-            "%s for std::string_view, "
+            "%s and %q for std::basic_string_view, "
             "%f for floating point types");
     }
 
@@ -298,7 +565,7 @@ namespace stdx::internals
     {};
 
     template <char formatter, typename StringType,
-        std::enable_if_t<std::is_same_v<StringType, std::string_view> &&
+        std::enable_if_t<is_string_view_v<StringType> &&
         formatter == 's'>* = nullptr>
     consteval void format_value()
     {};
@@ -309,31 +576,45 @@ namespace stdx::internals
     consteval void format_value()
     {};
 
+    template <char formatter, typename StringType,
+        std::enable_if_t<is_string_view_v<StringType> &&
+        formatter == 'q'>* = nullptr>
+    consteval void format_value()
+    {};
+
     /* Шаблонная функция, выполняющая преобразования исходных данных в
     конкретный тип на основе I-го плейсхолдера */
-    template <size_t I, format_string format, fixed_string source, typename Out>
+    template <size_t I, format_string format, basic_fixed_string source, typename Out>
     consteval Out parse_input()
     {
         constexpr std::pair<size_t, size_t> source_pos =
             get_parsing_boundaries<I, format, source>();
 
-        constexpr std::pair<size_t, size_t> format_pos =
-            format.placeholder_positions[I];
-        constexpr fixed_string<source_pos.second - source_pos.first + 1>
-            target{ source.data + source_pos.first,
-                source.data + source_pos.second };
-        
-        // Считывание значения
-        constexpr Out out = parse_value<target, Out>();
-        
-        // Случай наличия указаний по форматированию
-        if constexpr (format_pos.second - format_pos.first > 2)
+        constexpr char format_c = get_specifier<I, format>();
+
+        // Строка в кавычках разбирается отдельно от прочих значений
+        if constexpr (format_c == 'q')
         {
-            constexpr char format_c =
-                format.str.data[format_pos.first + 2];
             format_value<format_c, Out>();
+            return parse_quoted<source, source_pos.first, source_pos.second>();
         }
+        else
+        {
+            constexpr basic_fixed_string<typename decltype(source)::value_type,
+                source_pos.second - source_pos.first + 1>
+                target{ source.data + source_pos.first,
+                    source.data + source_pos.second };
 
-        return out;
+            // Считывание значения
+            constexpr Out out = parse_value<target, Out>();
+
+            // Случай наличия указаний по форматированию
+            if constexpr (format_c != '\0')
+            {
+                format_value<format_c, Out>();
+            }
+
+            return out;
+        }
     }
 } // namespace stdx::internals
\ No newline at end of file
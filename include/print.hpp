@@ -0,0 +1,312 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "parse.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace stdx::internals
+{
+    //=== Ядра записи значений ===
+    // Таблица пар цифр "00" ... "99" для записи целых по два разряда
+    constexpr std::array<char, 200> DIGIT_PAIRS =
+        []()
+        {
+            std::array<char, 200> out{};
+            for (size_t i = 0; i < 100; ++i)
+            {
+                out[2 * i] = static_cast<char>('0' + i / 10);
+                out[2 * i + 1] = static_cast<char>('0' + i % 10);
+            }
+            return out;
+        }();
+
+    template <typename UInt>
+    constexpr size_t count_digits(UInt value)
+    {
+        size_t out = 1;
+        while (value >= 10)
+        {
+            value /= 10;
+            ++out;
+        }
+        return out;
+    }
+
+    /* Запись целого числа без выделения памяти.
+    Возвращает указатель за последним записанным символом */
+    template <typename Int>
+    constexpr char* write_integer(char* out, const Int value)
+    {
+        using UInt = std::conditional_t<(sizeof(Int) <= sizeof(uint32_t)),
+            uint32_t, uint64_t>;
+
+        UInt u = static_cast<UInt>(value);
+        if constexpr (std::is_signed_v<Int>)
+        {
+            if (value < 0)
+            {
+                *out++ = '-';
+                u = UInt{0} - u;
+            }
+        }
+
+        const size_t n = count_digits(u);
+        char* pos = out + n;
+
+        while (u >= 100)
+        {
+            pos -= 2;
+            std::copy_n(&DIGIT_PAIRS[2 * (u % 100)], 2, pos);
+            u /= 100;
+        }
+
+        if (u >= 10)
+        {
+            std::copy_n(&DIGIT_PAIRS[2 * u], 2, pos - 2);
+        }
+        else
+        {
+            *--pos = static_cast<char>('0' + u);
+        }
+
+        return out + n;
+    }
+
+    /* Количество значащих цифр при записи числа с плавающей
+    точкой на этапе компиляции: дробная часть обязана помещаться
+    в int, которым оперирует parse_value<fs, double> */
+    constexpr const int CONSTEVAL_FLOAT_DIGITS = 9;
+
+    /* Запись числа с плавающей точкой.  Во время исполнения --
+    кратчайшее представление std::to_chars, однозначно читаемое
+    обратно; на этапе компиляции -- CONSTEVAL_FLOAT_DIGITS цифр */
+    template <typename Float>
+    constexpr char* write_float(char* out, const Float value)
+    {
+        if !consteval
+        {
+            return std::to_chars(out,
+                out + std::numeric_limits<Float>::max_digits10 + 8,
+                value).ptr;
+        }
+
+        double v = value;
+        if (v != v)
+        {
+            return std::copy_n("nan", 3, out);
+        }
+
+        if (v < 0)
+        {
+            *out++ = '-';
+            v = -v;
+        }
+
+        if (v > std::numeric_limits<double>::max())
+        {
+            return std::copy_n("inf", 3, out);
+        }
+
+        if (v == 0)
+        {
+            *out++ = '0';
+            return out;
+        }
+
+        // Нормализация к виду d.ddd * 10^exp
+        int exp = 0;
+        while (v >= 10)
+        {
+            v /= 10;
+            ++exp;
+        }
+        while (v < 1)
+        {
+            v *= 10;
+            --exp;
+        }
+
+        uint64_t scale = 1;
+        for (int i = 1; i < CONSTEVAL_FLOAT_DIGITS; ++i) scale *= 10;
+
+        uint64_t mantissa = static_cast<uint64_t>(v * scale + 0.5);
+        if (mantissa >= scale * 10)
+        {
+            mantissa /= 10;
+            ++exp;
+        }
+
+        // Отбрасываем завершающие нули дробной части
+        while (scale > 1 && mantissa % 10 == 0)
+        {
+            mantissa /= 10;
+            scale /= 10;
+        }
+
+        *out++ = static_cast<char>('0' + mantissa / scale);
+        if (scale > 1)
+        {
+            *out++ = '.';
+            for (scale /= 10; scale; scale /= 10)
+            {
+                *out++ = static_cast<char>('0' + (mantissa / scale) % 10);
+            }
+        }
+
+        if (exp)
+        {
+            *out++ = 'e';
+            out = write_integer(out, exp);
+        }
+
+        return out;
+    }
+
+    /* Запись строки в кавычках с экранированием -- обратная
+    операция к find_closing_quote и unescape */
+    constexpr char* write_quoted(char* out, std::string_view value)
+    {
+        *out++ = '"';
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':  *out++ = '\\'; *out++ = '"'; break;
+            case '\\': *out++ = '\\'; *out++ = '\\'; break;
+            case '\n': *out++ = '\\'; *out++ = 'n'; break;
+            case '\t': *out++ = '\\'; *out++ = 't'; break;
+            case '\r': *out++ = '\\'; *out++ = 'r'; break;
+            case '\0': *out++ = '\\'; *out++ = '0'; break;
+            default:   *out++ = c; break;
+            }
+        }
+        *out++ = '"';
+        return out;
+    }
+
+    /* Копирование участка форматирующей строки известной на этапе
+    компиляции длины -- во время исполнения превращается в memcpy
+    фиксированного размера */
+    template <format_string format, size_t begin, size_t length>
+    constexpr char* write_literal(char* out)
+    {
+        if constexpr (!length) return out;
+        else
+        {
+            if !consteval
+            {
+                std::memcpy(out, format.str.data + begin, length);
+                return out + length;
+            }
+            return std::copy_n(format.str.data + begin, length, out);
+        }
+    }
+
+    /* Наибольшая длина записи значения типа T; для строк
+    длина не ограничена и определяется значением */
+    template <typename T>
+    constexpr size_t max_value_size()
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            return std::numeric_limits<T>::digits10 + 2;
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return std::numeric_limits<T>::max_digits10 + 8;
+        }
+        else return 0;
+    }
+
+    // Верхняя граница длины записи конкретного значения
+    template <typename T>
+    constexpr size_t value_size_bound(const T& value)
+    {
+        // Худший случай для строк -- %q с экранированием каждого символа
+        if constexpr (std::is_same_v<T, std::string_view>)
+        {
+            return 2 * value.size() + 2;
+        }
+        else return max_value_size<T>();
+    }
+
+    // Запись значения I-го плейсхолдера
+    template <size_t I, format_string format, typename T>
+    constexpr char* print_value(char* out, const T& value)
+    {
+        constexpr char format_c = get_specifier<I, format>();
+        if constexpr (format_c != '\0')
+        {
+            format_value<format_c, T>();
+        }
+
+        if constexpr (std::is_same_v<T, std::string_view>)
+        {
+            if constexpr (format_c == 'q') return write_quoted(out, value);
+            else return std::copy_n(value.data(), value.size(), out);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return write_float(out, value);
+        }
+        else return write_integer(out, value);
+    }
+} // namespace stdx::internals
+
+namespace stdx
+{
+    using namespace stdx::internals;
+
+    /* Наибольшая длина вывода print_to для набора типов Ts...
+    Определена, только если среди Ts нет строк */
+    template <format_string format, typename... Ts>
+        requires (!(... || std::is_same_v<Ts, std::string_view>))
+    constexpr size_t max_print_size =
+        get_literal_size<format>() + (0 + ... + max_value_size<Ts>());
+
+    // Верхняя граница длины вывода print_to для конкретных значений
+    template <format_string format, typename... Ts>
+    [[nodiscard]] constexpr size_t print_size_bound(const Ts&... values)
+    {
+        return get_literal_size<format>() +
+            (0 + ... + value_size_bound(values));
+    }
+
+    /* Обратная к scan операция: запись значений в out по той же
+    форматирующей строке.  Память не выделяется; буфер должен вмещать
+    print_size_bound<format>(values...) символов.  Возвращает указатель
+    за последним записанным символом */
+    template <format_string format, typename... Ts>
+    constexpr char* print_to(char* out, const Ts&... values)
+    {
+        static_assert((... && is_supported_type_v<Ts>),
+            "Only integral types, float, double and "
+            "std::string_view are accepted");
+        static_assert(sizeof...(Ts) == format.n_placeholders,
+            "The number of values does not match the format string");
+        static_assert(std::is_same_v<typename decltype(format)::char_type, char> &&
+            (... && is_compatible_view_v<Ts, char>),
+            "Only char format strings can be printed");
+
+        return [&]<size_t... I>(indices<I...>)
+            {
+                (..., (out = print_value<I, format>(
+                    write_literal<format,
+                        get_literal_before<I, format>().first,
+                        get_literal_before<I, format>().second>(out),
+                    values)));
+
+                return write_literal<format,
+                    get_literal_after<format>().first,
+                    get_literal_after<format>().second>(out);
+            }(generate_indices<format.n_placeholders>{});
+    }
+} // namespace stdx
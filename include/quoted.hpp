@@ -0,0 +1,177 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace stdx::internals
+{
+    /* Битовые маски 64-байтового блока: бит i соответствует
+    i-ому байту блока (по образцу simdjson) */
+    struct quote_masks
+    {
+        uint64_t quotes = 0;        // Все кавычки '"'
+        uint64_t backslashes = 0;   // Все обратные слэши '\'
+        uint64_t escaped = 0;       // Символы, экранированные слэшем
+    };
+
+    constexpr const size_t QUOTE_BLOCK_SIZE = 64;
+
+    /* Маска кодовых единиц блока, равных c.  Векторный вариант --
+    для однобайтовых единиц, более широкие сравниваются по одной */
+    template <typename CharT>
+    constexpr uint64_t match_mask(const CharT* block, const char c)
+    {
+#if defined(__SSE2__)
+        if !consteval
+        {
+            if constexpr (sizeof(CharT) == 1)
+            {
+                const __m128i needle = _mm_set1_epi8(c);
+                uint64_t out = 0;
+                for (size_t i = 0; i < QUOTE_BLOCK_SIZE; i += 16)
+                {
+                    const __m128i chunk = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(block + i));
+                    const uint64_t bits = static_cast<uint16_t>(
+                        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+                    out |= bits << i;
+                }
+                return out;
+            }
+        }
+#endif
+        uint64_t out = 0;
+        for (size_t i = 0; i < QUOTE_BLOCK_SIZE; ++i)
+        {
+            out |= static_cast<uint64_t>(block[i] == CharT(c)) << i;
+        }
+        return out;
+    }
+
+    /* Поиск экранированных символов без ветвлений: символ экранирован,
+    если перед ним стоит нечётная серия слэшей.  prev_escaped переносит
+    состояние между соседними блоками (первый символ следующего блока
+    экранирован слэшем из конца текущего). */
+    constexpr uint64_t find_escaped(uint64_t backslashes,
+        uint64_t& prev_escaped)
+    {
+        constexpr uint64_t even_bits = 0x5555'5555'5555'5555ULL;
+
+        backslashes &= ~prev_escaped;
+        const uint64_t follows_escape = (backslashes << 1) | prev_escaped;
+
+        // Серии слэшей, начинающиеся на нечётной позиции
+        const uint64_t odd_starts = backslashes & ~even_bits & ~follows_escape;
+
+        /* Сложение "протаскивает" начало серии до её конца; перенос
+        за 64-ый бит означает, что серия продолжается в следующем блоке */
+        const uint64_t sequences_on_even = odd_starts + backslashes;
+        prev_escaped = sequences_on_even < odd_starts;
+
+        const uint64_t invert_mask = sequences_on_even << 1;
+        return (even_bits ^ invert_mask) & follows_escape;
+    }
+
+    // Классификация одного блока ровно из QUOTE_BLOCK_SIZE кодовых единиц
+    template <typename CharT>
+    constexpr quote_masks classify_block(const CharT* block,
+        uint64_t& prev_escaped)
+    {
+        quote_masks out;
+        out.quotes = match_mask(block, '"');
+        out.backslashes = match_mask(block, '\\');
+        out.escaped = find_escaped(out.backslashes, prev_escaped);
+        return out;
+    }
+
+    // Результат поиска закрывающей кавычки
+    struct quoted_span
+    {
+        size_t close = std::string_view::npos;  // Позиция закрывающей кавычки
+        bool has_escapes = false;               // Требуется ли разэкранирование
+    };
+
+    /* Поиск закрывающей кавычки для строки, открытой кавычкой
+    в позиции open.  Источник обрабатывается блоками по 64 кодовые
+    единицы, хвост копируется в дополненный нулями буфер. */
+    template <typename CharT>
+    constexpr quoted_span find_closing_quote(std::basic_string_view<CharT> src,
+        const size_t open)
+    {
+        quoted_span out;
+        uint64_t prev_escaped = 0;
+        size_t pos = open + 1;
+
+        while (pos < src.size())
+        {
+            const size_t left = src.size() - pos;
+            CharT tail[QUOTE_BLOCK_SIZE]{};
+            const CharT* block = src.data() + pos;
+            uint64_t valid = ~0ULL;
+
+            if (left < QUOTE_BLOCK_SIZE)
+            {
+                for (size_t i = 0; i < left; ++i) tail[i] = block[i];
+                block = tail;
+                valid = (1ULL << left) - 1;
+            }
+
+            const quote_masks masks = classify_block(block, prev_escaped);
+            const uint64_t closing = masks.quotes & ~masks.escaped & valid;
+
+            if (closing)
+            {
+                const int offset = std::countr_zero(closing);
+                const uint64_t before = (1ULL << offset) - 1;
+                out.close = pos + static_cast<size_t>(offset);
+                out.has_escapes |= !!(masks.backslashes & before);
+                return out;
+            }
+
+            out.has_escapes |= !!(masks.backslashes & valid);
+            pos += QUOTE_BLOCK_SIZE;
+        }
+
+        return out;
+    }
+
+    // Однобайтовый источник, в том числе заданный списком инициализации
+    constexpr quoted_span find_closing_quote(std::string_view src,
+        const size_t open)
+    {
+        return find_closing_quote<char>(src, open);
+    }
+
+    /* Разэкранирование содержимого кавычек в out (не менее body.size()
+    кодовых единиц).  Возвращает число записанных единиц. */
+    template <typename CharT>
+    constexpr size_t unescape(std::basic_string_view<CharT> body, CharT* out)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < body.size(); ++i)
+        {
+            if (body[i] != '\\' || i + 1 == body.size())
+            {
+                out[n++] = body[i];
+                continue;
+            }
+
+            switch (body[++i])
+            {
+            case 'n': out[n++] = '\n'; break;
+            case 't': out[n++] = '\t'; break;
+            case 'r': out[n++] = '\r'; break;
+            case '0': out[n++] = '\0'; break;
+            default: out[n++] = body[i]; break;
+            }
+        }
+
+        return n;
+    }
+}  // namespace stdx::internals
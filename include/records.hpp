@@ -0,0 +1,137 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "scanner.hpp"
+
+#include <array>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <string_view>
+#include <utility>
+
+namespace stdx::internals
+{
+    /* Многострочный источник на этапе компиляции -- fixed_string либо
+    массив char (в том числе заполненный через #embed).  Источник
+    передаётся ссылкой на объект со статическим временем жизни, поэтому
+    не копируется побайтно при каждой инстанциации */
+    template <size_t capacity>
+    constexpr std::string_view as_view(const fixed_string<capacity>& data)
+    {
+        return { data.data, data.size };
+    }
+
+    // Завершающий ноль строкового литерала в данные не входит
+    template <size_t size>
+    constexpr std::string_view as_view(const char (&data)[size])
+    {
+        return { data, (size && data[size - 1] == '\0') ? size - 1 : size };
+    }
+
+    /* Обход записей источника: записи разделены '\n', завершающий
+    '\r' отбрасывается, пустые строки пропускаются.  Для каждой записи
+    вызывается on_record(начало, конец) */
+    template <typename F>
+    constexpr void for_each_record(std::string_view source, F&& on_record)
+    {
+        size_t pos = 0;
+        while (pos < source.size())
+        {
+            size_t end = find_separator(source, std::string_view{ "\n" }, pos);
+            if (end == std::string_view::npos) end = source.size();
+
+            const size_t next = end + 1;
+            if (end > pos && source[end - 1] == '\r') --end;
+            if (end > pos) on_record(pos, end);
+
+            pos = next;
+        }
+    }
+
+    template <const auto& data>
+    constexpr size_t record_count = []()
+        {
+            size_t out = 0;
+            for_each_record(as_view(data), [&](size_t, size_t) { ++out; });
+            return out;
+        }();
+
+    // Границы всех записей -- один проход по источнику
+    template <const auto& data>
+    constexpr std::array<std::pair<size_t, size_t>, record_count<data>>
+    record_bounds = []()
+        {
+            std::array<std::pair<size_t, size_t>, record_count<data>> out{};
+            size_t i = 0;
+            for_each_record(as_view(data), [&](size_t begin, size_t end)
+                {
+                    out[i++] = { begin, end };
+                });
+            return out;
+        }();
+
+    /* Записи сканируются порциями: каждая порция -- отдельное
+    константное выражение со своим лимитом шагов вычисления
+    (-fconstexpr-steps, -fconstexpr-ops-limit), поэтому общий объём
+    источника ограничен лишь памятью компилятора */
+    constexpr const size_t RECORD_CHUNK_SIZE = 256;
+
+    template <typename... Ts>
+    struct record_chunk
+    {
+        // scan_result не присваивается, поэтому хранятся кортежи значений
+        std::array<std::tuple<std::remove_cv_t<Ts>...>, RECORD_CHUNK_SIZE> records{};
+
+        // Номер первой несовпавшей записи, считая с 1, либо 0
+        size_t mismatch = 0;
+    };
+
+    template <format_string format, const auto& data, size_t chunk,
+        typename... Ts>
+    consteval record_chunk<Ts...> scan_chunk()
+    {
+        const std::string_view source = as_view(data);
+        const auto& bounds = record_bounds<data>;
+
+        /* Элементы явно инициализируются по одному: GCC 12 падает при
+        копировании частично заполненного массива на этапе компиляции */
+        record_chunk<Ts...> out;
+        for (auto& record : out.records) record = {};
+
+        for (size_t i = 0; i < RECORD_CHUNK_SIZE; ++i)
+        {
+            const size_t record = chunk * RECORD_CHUNK_SIZE + i;
+            if (record >= bounds.size()) break;
+
+            const auto [begin, end] = bounds[record];
+            const auto result = scanner<format>::template scan<Ts...>(
+                source.substr(begin, end - begin));
+            if (!result)
+            {
+                out.mismatch = record + 1;
+                break;
+            }
+
+            out.records[i] = result->values;
+        }
+
+        return out;
+    }
+
+    template <format_string format, const auto& data, size_t chunk,
+        typename... Ts>
+    constexpr record_chunk<Ts...> scanned_chunk =
+        scan_chunk<format, data, chunk, Ts...>();
+
+    template <typename... Ts>
+    constexpr scan_result<Ts...> make_record(
+        std::tuple<std::remove_cv_t<Ts>...> values)
+    {
+        return std::apply([](auto&... value)
+            {
+                return scan_result<Ts...>{ std::move(value)... };
+            }, values);
+    }
+}  // namespace stdx::internals
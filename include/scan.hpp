@@ -3,31 +3,124 @@
 #include "types.hpp"
 #include "format_string.hpp"
 #include "parse.hpp"
+#include "print.hpp"
+#include "instrumentation.hpp"
+#include "scanner.hpp"
+#include "compiled_format.hpp"
+#include "records.hpp"
+#include "field_index.hpp"
+#include "batch.hpp"
+#include "packed.hpp"
+
+#include <array>
+#include <utility>
 
 namespace stdx
 {
     using namespace stdx::internals;
 
-    // Главная функция
+    /* Главная функция.  Источник и форматирующая строка -- из одних
+    и тех же кодовых единиц: char, wchar_t, char8_t, char16_t либо
+    char32_t */
     template <format_string format, 
-        fixed_string source, typename... Ts>
+        basic_fixed_string source, typename... Ts>
     [[nodiscard]] consteval scan_result<Ts...> scan()
     {
         using namespace stdx::internals;
+        using char_type = typename decltype(format)::char_type;
 
         /* Можно обыграть с помощью requires, но так можно в 
         явном виде прописать указание на причину ошибки. */
-        static_assert((... && (!std::is_reference_v<Ts> && 
-            (std::is_integral_v<Ts> || 
-            std::is_floating_point_v<Ts> || 
-            std::is_same_v<Ts, std::string_view>))),
+        static_assert((... && is_supported_type_v<Ts>),
             "Only integral types, float, double and "
-            "std::string_view are accepted; "
+            "std::basic_string_view are accepted; "
             "references are not permitted");
+        static_assert(std::is_same_v<typename decltype(source)::value_type,
+            char_type>, "The source and the format string must use "
+            "the same character type");
+        static_assert((... && is_compatible_view_v<Ts, char_type>),
+            "String views must use the character type "
+            "of the format string");
 
         return []<size_t... I>(indices<I...>)
             {
                 return scan_result<Ts...>{parse_input<I, format, source, Ts>()...};
             }(generate_indices<format.n_placeholders>{});
     }
+
+    /* Сканирование источника времени исполнения.  Форматирующая строка
+    известна на этапе компиляции; значения %q с экранированием
+    разэкранируются в arena.  При несоответствии источника формату
+    возвращается scan_error: причина, номер плейсхолдера и смещение.
+    Источник -- вид на те же кодовые единицы, что и форматирующая
+    строка */
+    template <format_string format, typename... Ts>
+    [[nodiscard]] constexpr std::expected<scan_result<Ts...>, scan_error>
+    scan(typename scanner<format>::view_type source,
+        scan_arena* arena = nullptr)
+    {
+        return scanner<format>::template scan<Ts...>(source, arena);
+    }
+
+    /* Пакетное сканирование записей в столбцы значений: сначала ищутся
+    границы полей блока записей, затем поля каждого плейсхолдера
+    преобразуются векторными ядрами.  Несовпавшие записи отмечаются
+    нулём в column_batch::valid */
+    template <format_string format, typename... Ts>
+    [[nodiscard]] constexpr column_batch<Ts...>
+    scan_batch(std::span<const std::string_view> records,
+        scan_arena* arena = nullptr)
+    {
+        return batch_scanner<format>::template scan<Ts...>(records, arena);
+    }
+
+    /* То же в столбцы out, память которых используется повторно --
+    для потоковой обработки порциями */
+    template <format_string format, typename... Ts>
+    constexpr void scan_batch(std::span<const std::string_view> records,
+        column_batch<Ts...>& out, scan_arena* arena = nullptr)
+    {
+        batch_scanner<format>::template scan<Ts...>(records, out, arena);
+    }
+
+    /* Сканирование всех записей (строк) источника на этапе компиляции.
+    data -- fixed_string или массив char со статическим временем жизни,
+    например заполненный через #embed.  Число записей вычисляется на
+    этапе компиляции; несовпадение записи с форматом -- ошибка
+    компиляции.  Значения %q с экранированием не поддерживаются:
+    разэкранированной строке негде жить после вычисления */
+    template <format_string format, const auto& data, typename... Ts>
+    [[nodiscard]] consteval auto scan_all()
+    {
+        using namespace stdx::internals;
+
+        static_assert((... && is_supported_type_v<Ts>),
+            "Only integral types, float, double and "
+            "std::string_view are accepted; "
+            "references are not permitted");
+
+        static_assert(std::is_same_v<typename decltype(format)::char_type, char>,
+            "Only char format strings are accepted for multi-record sources");
+
+        constexpr size_t n_records = record_count<data>;
+        constexpr size_t n_chunks =
+            (n_records + RECORD_CHUNK_SIZE - 1) / RECORD_CHUNK_SIZE;
+
+        static_assert(
+            []<size_t... C>(std::index_sequence<C...>)
+            {
+                return (... && !scanned_chunk<format, data, C, Ts...>.mismatch);
+            }(std::make_index_sequence<n_chunks>{}),
+            "A record does not match the format string");
+
+        /* Записей может быть много тысяч, поэтому индексы строятся
+        встроенным std::make_index_sequence, а не рекурсивным
+        generate_indices */
+        return []<size_t... R>(std::index_sequence<R...>)
+            {
+                return std::array<scan_result<Ts...>, n_records>{
+                    make_record<Ts...>(scanned_chunk<format, data,
+                        R / RECORD_CHUNK_SIZE, Ts...>.records[R % RECORD_CHUNK_SIZE])... };
+            }(std::make_index_sequence<n_records>{});
+    }
 } // namespace stdx
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+/* Холодный путь: функции, которые вызываются лишь при ошибке, выносятся
+из горячего кода и не встраиваются в него */
+#if defined(__GNUC__)
+#define STDX_SCAN_COLD [[gnu::cold, gnu::noinline]]
+#else
+#define STDX_SCAN_COLD
+#endif
+
+namespace stdx::internals
+{
+    // Причина несоответствия источника формату
+    enum class mismatch_reason : uint8_t
+    {
+        unclosed_quote,         // Незакрытая кавычка в значении %q
+        invalid_value,          // Неверный формат значения
+        out_of_range,           // Значение не помещается в тип
+        no_arena,               // Для разэкранирования %q нужна арена
+        literal_mismatch,       // Текст формата не найден в источнике
+        type_mismatch,          // Типы не соответствуют формату времени исполнения
+        count
+    };
+
+    constexpr mismatch_reason to_mismatch_reason(const std::errc ec)
+    {
+        switch (ec)
+        {
+        case std::errc::result_out_of_range: return mismatch_reason::out_of_range;
+        case std::errc::not_enough_memory: return mismatch_reason::no_arena;
+        default: return mismatch_reason::invalid_value;
+        }
+    }
+
+    /* Ошибка сканирования во время исполнения: причина, номер
+    плейсхолдера и смещение (в кодовых единицах от начала источника)
+    поля либо текста, на котором сканирование остановилось.  Без строк
+    и выделений памяти -- 16 байт, которые заполняются только при
+    ошибке */
+    struct scan_error
+    {
+        size_t offset = 0;
+        uint32_t placeholder = 0;
+        mismatch_reason code = mismatch_reason::invalid_value;
+
+        constexpr bool operator==(const scan_error&) const = default;
+    };
+
+    STDX_SCAN_COLD constexpr scan_error make_scan_error(
+        const mismatch_reason code, const size_t placeholder,
+        const size_t offset)
+    {
+        return { offset, static_cast<uint32_t>(placeholder), code };
+    }
+}  // namespace stdx::internals
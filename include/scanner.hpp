@@ -0,0 +1,403 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+#include "parse.hpp"
+#include "arena.hpp"
+#include "convert.hpp"
+#include "instrumentation.hpp"
+#include "search.hpp"
+#include "scan_error.hpp"
+#include "shape.hpp"
+
+#include <algorithm>
+#include <array>
+#include <expected>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stdx::internals
+{
+    // Границы поля в источнике и позиция, с которой начинается следующее
+    struct field_bounds
+    {
+        size_t begin;
+        size_t end;
+        size_t next;
+    };
+
+    /* Поиск поля, начинающегося в start и завершающегося разделителем sep.
+    Повторяет логику get_parsing_boundaries: без разделителя последнее
+    поле тянется до конца источника (текст после последнего плейсхолдера
+    к этому моменту уже отрезан, см. anchor_fields), а ненайденный
+    разделитель -- несовпадение.  Для %q разделитель ищется после
+    закрывающей кавычки; незакрытая кавычка -- ошибка.  При flexible
+    разделитель сопоставляется с гибкими пробелами (find_flexible) */
+    template <bool flexible = false, typename CharT>
+    constexpr std::expected<field_bounds, mismatch_reason> find_field(
+        std::basic_string_view<CharT> source, size_t start,
+        std::basic_string_view<CharT> sep, bool is_last, bool is_quoted)
+    {
+        if (start > source.size()) start = source.size();
+
+        size_t search_start = start;
+        if (is_quoted && start < source.size() && source[start] == '"')
+        {
+            const quoted_span span = find_closing_quote(source, start);
+            if (span.close == std::string_view::npos)
+            {
+                return std::unexpected(mismatch_reason::unclosed_quote);
+            }
+            search_start = span.close + 1;
+        }
+
+        if (sep.empty())
+        {
+            const size_t end = is_last ? source.size() : start;
+            return field_bounds{ start, end, end };
+        }
+
+        literal_match match;
+        if constexpr (flexible)
+        {
+            match = find_flexible(source, sep, search_start);
+        }
+        else
+        {
+            const size_t pos = find_separator(source, sep, search_start);
+            if (pos != std::string_view::npos) match = { pos, pos + sep.size() };
+        }
+
+        if (match.begin == std::string_view::npos)
+        {
+            return std::unexpected(mismatch_reason::literal_mismatch);
+        }
+        return field_bounds{ start, match.begin, match.end };
+    }
+
+    /* Часть источника между текстом перед первым и после последнего
+    плейсхолдеров.  При несовпадении begin == npos, а end и placeholder --
+    смещение и номер плейсхолдера для scan_error */
+    struct field_region
+    {
+        size_t begin = std::string_view::npos;
+        size_t end = std::string_view::npos;
+        size_t placeholder = 0;
+    };
+
+    /* Привязка источника к формату до разбора полей: длина не меньше
+    get_min_source_size, текст перед первым плейсхолдером совпадает с
+    началом источника, а текст после последнего -- с концом.  Точные
+    литералы сравниваются словами известной на этапе компиляции длины
+    (equal_units), гибкие -- match_flexible и match_flexible_back.
+    Формат без плейсхолдеров должен совпасть с источником целиком.
+    Несовпадение указывает на конец короткого источника, на начало
+    текста перед первым плейсхолдером (плейсхолдер 0) либо на место
+    текста после последнего (последний плейсхолдер) */
+    template <format_string format>
+    constexpr field_region anchor_fields(
+        std::basic_string_view<typename decltype(format)::char_type> source)
+    {
+        constexpr size_t last = format.n_placeholders ? format.n_placeholders - 1 : 0;
+
+        if (source.size() < get_min_source_size<format>()) [[unlikely]]
+        {
+            return { std::string_view::npos, source.size(), 0 };
+        }
+
+        constexpr std::pair<size_t, size_t> prefix = []()
+            {
+                if constexpr (format.n_placeholders)
+                {
+                    return get_literal_before<0, format>();
+                }
+                else return get_literal_after<format>();
+            }();
+        constexpr std::pair<size_t, size_t> suffix = format.n_placeholders
+            ? get_literal_after<format>()
+            : std::pair<size_t, size_t>{ format.str.size, 0 };
+
+        size_t begin = prefix.second;
+        if constexpr (is_flexible_literal<format>(prefix))
+        {
+            begin = match_flexible(source,
+                format.str.sv().substr(prefix.first, prefix.second), 0);
+            if (begin == std::string_view::npos)
+            {
+                return { std::string_view::npos, 0, 0 };
+            }
+        }
+        else if (!equal_units<prefix.second>(source.data(),
+            format.str.data + prefix.first))
+        {
+            return { std::string_view::npos, 0, 0 };
+        }
+
+        // Гибкий текст может быть длиннее своего совпадения
+        const size_t suffix_at = source.size() - std::min(source.size(), suffix.second);
+
+        size_t end = suffix_at;
+        if constexpr (is_flexible_literal<format>(suffix))
+        {
+            end = match_flexible_back(source,
+                format.str.sv().substr(suffix.first, suffix.second), begin);
+            if (end == std::string_view::npos)
+            {
+                return { std::string_view::npos, suffix_at, last };
+            }
+        }
+        else if (end < begin || !equal_units<suffix.second>(source.data() + end,
+            format.str.data + suffix.first))
+        {
+            return { std::string_view::npos, suffix_at, last };
+        }
+
+        if constexpr (!format.n_placeholders)
+        {
+            if (begin != end) return { std::string_view::npos, begin, 0 };
+        }
+        return { begin, end };
+    }
+
+    /* Поиск I-го поля источника из start: разделитель и способ его
+    поиска выбираются на этапе компиляции.  Источник -- уже без текста
+    после последнего плейсхолдера, поэтому формат -- обычно форма
+    (format_shape), в которой этого текста нет */
+    template <size_t I, format_string format>
+    constexpr std::expected<field_bounds, mismatch_reason> find_placeholder_field(
+        std::basic_string_view<typename decltype(format)::char_type> source,
+        const size_t start)
+    {
+        constexpr std::pair<size_t, size_t> sep_pos =
+            get_separator_after<I, format>();
+
+        return find_field<is_flexible_literal<format>(sep_pos)>(source, start,
+            format.str.sv().substr(sep_pos.first, sep_pos.second),
+            I + 1 == format.n_placeholders, get_specifier<I, format>() == 'q');
+    }
+
+    // Такты по фазам сканирования одной записи
+    using phase_cycles = std::array<uint64_t, size_t(scan_phase::count)>;
+
+    /* Разбор полей по форме формата (см. shape.hpp) начиная с pos;
+    source -- уже без текста после последнего плейсхолдера.  Общий для
+    всех форматов одной формы: не знает ни текста вокруг плейсхолдеров,
+    ни букв, кроме %q, и не вызывает обработчиков
+    инструментирования.  Sampler -- политика с read_cycles() при
+    замерах тактов либо no_instrumentation, поэтому без замеров
+    инстанциация одна на форму и набор типов */
+    template <format_string shape, typename Sampler = no_instrumentation>
+    struct shape_scanner
+    {
+        using char_type = typename decltype(shape)::char_type;
+        using view_type = std::basic_string_view<char_type>;
+
+        template <typename... Ts>
+        [[nodiscard]] constexpr static std::expected<scan_result<Ts...>, scan_error>
+        scan(view_type source, size_t pos, scan_arena* arena,
+            phase_cycles& cycles)
+        {
+            return [&]<size_t... I>(indices<I...>)
+                -> std::expected<scan_result<Ts...>, scan_error>
+            {
+                std::tuple<std::remove_cv_t<Ts>...> values;
+
+                scan_error error;
+                if (!(... && scan_field<I>(source, pos,
+                    std::get<I>(values), arena, cycles, error))) [[unlikely]]
+                {
+                    return std::unexpected(error);
+                }
+
+                return scan_result<Ts...>{ std::move(std::get<I>(values))... };
+            }(generate_indices<shape.n_placeholders>{});
+        }
+
+    private:
+        template <size_t I, typename T>
+        constexpr static bool scan_field(view_type source, size_t& pos,
+            T& out, scan_arena* arena, phase_cycles& cycles, scan_error& error)
+        {
+            const uint64_t search_start = start_phase();
+            const std::expected<field_bounds, mismatch_reason> bounds =
+                find_placeholder_field<I, shape>(source, pos);
+            end_phase(cycles, scan_phase::separator_search, search_start);
+
+            if (!bounds) [[unlikely]]
+            {
+                error = make_scan_error(bounds.error(), I, pos);
+                return false;
+            }
+
+            pos = bounds->next;
+
+            const uint64_t conversion_start = start_phase();
+            const std::errc ec = convert_field(
+                source.substr(bounds->begin, bounds->end - bounds->begin),
+                get_specifier<I, shape>(), out, arena);
+            end_phase(cycles, scan_phase::conversion, conversion_start);
+
+            if (ec != std::errc{}) [[unlikely]]
+            {
+                error = make_scan_error(to_mismatch_reason(ec), I, bounds->begin);
+                return false;
+            }
+            return true;
+        }
+
+        //=== Замеры тактов ===
+        constexpr static uint64_t start_phase()
+        {
+            if constexpr (Sampler::sample_cycles)
+            {
+                if !consteval
+                {
+                    return Sampler::read_cycles();
+                }
+            }
+            return 0;
+        }
+
+        constexpr static void end_phase([[maybe_unused]] phase_cycles& cycles,
+            [[maybe_unused]] const scan_phase phase,
+            [[maybe_unused]] const uint64_t start)
+        {
+            if constexpr (Sampler::sample_cycles)
+            {
+                if !consteval
+                {
+                    cycles[size_t(phase)] += Sampler::read_cycles() - start;
+                }
+            }
+        }
+    };
+
+    /* Сканирование источника, известного только во время исполнения,
+    по форматирующей строке, известной на этапе компиляции.  Разделители,
+    форматирующие буквы и проверка типов вычисляются на этапе компиляции,
+    во время исполнения остаются поиск разделителей и преобразования.
+    Источник состоит из тех же кодовых единиц, что и форматирующая
+    строка (char, wchar_t, char8_t, char16_t либо char32_t).
+
+    Сам scanner -- тонкая обёртка: проверяет типы, привязывает источник
+    к тексту перед первым и после последнего плейсхолдеров (anchor_fields)
+    и вызывает обработчики, а поля разбирает shape_scanner формы формата,
+    общий для форматов, различающихся лишь этим текстом и буквами
+    плейсхолдеров.
+
+    Instrumentation -- политика инструментирования (см.
+    instrumentation.hpp); обработчики вызываются только во время
+    исполнения, а политика по умолчанию не порождает никакого кода */
+    template <format_string format,
+        typename Instrumentation = no_instrumentation>
+    struct scanner
+    {
+        using char_type = typename decltype(format)::char_type;
+        using view_type = std::basic_string_view<char_type>;
+
+        /* При несоответствии источника формату возвращается scan_error;
+        он заполняется только на холодном пути ошибки */
+        template <typename... Ts>
+        [[nodiscard]] constexpr static std::expected<scan_result<Ts...>, scan_error>
+        scan(view_type source, scan_arena* arena = nullptr)
+        {
+            static_assert((... && is_supported_type_v<Ts>),
+                "Only integral types, float, double and "
+                "std::basic_string_view are accepted; "
+                "references are not permitted");
+            static_assert((... && is_compatible_view_v<Ts, char_type>),
+                "String views must use the character type "
+                "of the format string");
+            static_assert(sizeof...(Ts) == format.n_placeholders,
+                "The number of types does not match the format string");
+
+            // Буквы проверяются здесь: форма их не хранит
+            [&]<size_t... I>(indices<I...>)
+            {
+                (..., check_specifier<I, std::tuple_element_t<I, std::tuple<Ts...>>>());
+            }(generate_indices<format.n_placeholders>{});
+
+            if constexpr (Instrumentation::enabled)
+            {
+                if !consteval
+                {
+                    Instrumentation::template on_record<format>(source.size());
+                }
+            }
+
+            const field_region region = anchor_fields<format>(source);
+            if (region.begin == std::string_view::npos) [[unlikely]]
+            {
+                return std::unexpected(fail(make_scan_error(
+                    mismatch_reason::literal_mismatch, region.placeholder,
+                    region.end)));
+            }
+
+            phase_cycles cycles{};
+            std::expected<scan_result<Ts...>, scan_error> out =
+                shape_scanner<format_shape<format>{}, sampler>::template
+                    scan<Ts...>(source.substr(0, region.end), region.begin,
+                        arena, cycles);
+
+            if constexpr (Instrumentation::sample_cycles)
+            {
+                if !consteval
+                {
+                    Instrumentation::template on_phase<format>(
+                        scan_phase::separator_search,
+                        cycles[size_t(scan_phase::separator_search)]);
+                    Instrumentation::template on_phase<format>(
+                        scan_phase::conversion,
+                        cycles[size_t(scan_phase::conversion)]);
+                }
+            }
+
+            if (!out) [[unlikely]]
+            {
+                return std::unexpected(fail(out.error()));
+            }
+
+            if constexpr (Instrumentation::enabled)
+            {
+                if !consteval
+                {
+                    Instrumentation::template on_match<format>();
+                }
+            }
+
+            return out;
+        }
+
+    private:
+        // Политика замеров тактов для shape_scanner
+        using sampler = std::conditional_t<Instrumentation::sample_cycles,
+            Instrumentation, no_instrumentation>;
+
+        template <size_t I, typename T>
+        constexpr static void check_specifier()
+        {
+            constexpr char format_c = get_specifier<I, format>();
+            if constexpr (format_c != '\0')
+            {
+                format_value<format_c, T>();
+            }
+        }
+
+        // Несоответствие: обработчик вызывается только здесь
+        STDX_SCAN_COLD constexpr static scan_error fail(const scan_error error)
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                if !consteval
+                {
+                    Instrumentation::template on_mismatch<format>(error.code,
+                        error.placeholder);
+                }
+            }
+            return error;
+        }
+    };
+}  // namespace stdx::internals
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace stdx::internals
+{
+    /* Поиск двух- либо четырёхбайтовой кодовой единицы: 16 байт за шаг
+    сравнением по ширине единицы (SSE2) */
+    template <typename CharT>
+    size_t find_wide_char(std::basic_string_view<CharT> source, const CharT c,
+        size_t from)
+    {
+#if defined(__SSE2__)
+        constexpr size_t step = 16 / sizeof(CharT);
+
+        const __m128i needle = (sizeof(CharT) == 2)
+            ? _mm_set1_epi16(static_cast<short>(c))
+            : _mm_set1_epi32(static_cast<int>(c));
+
+        for (; from + step <= source.size(); from += step)
+        {
+            const __m128i chunk = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(source.data() + from));
+            const __m128i eq = (sizeof(CharT) == 2)
+                ? _mm_cmpeq_epi16(chunk, needle)
+                : _mm_cmpeq_epi32(chunk, needle);
+
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+            if (mask) return from + std::countr_zero(mask) / sizeof(CharT);
+        }
+#endif
+        return source.find(c, from);
+    }
+
+    /* Поиск символа.  Во время исполнения однобайтовые единицы ищутся
+    через memchr, более широкие -- через find_wide_char.  На этапе
+    компиляции, где это умеет компилятор (Clang), однобайтовые единицы
+    ищутся встроенным __builtin_char_memchr, который расходует один шаг
+    вычисления вместо шага на байт */
+    template <typename CharT>
+    constexpr size_t find_char(std::basic_string_view<CharT> source,
+        const CharT c, const size_t from)
+    {
+        if constexpr (sizeof(CharT) > 1)
+        {
+            if !consteval
+            {
+                return (from < source.size())
+                    ? find_wide_char(source, c, from)
+                    : std::string_view::npos;
+            }
+        }
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_char_memchr)
+        else if constexpr (std::is_same_v<CharT, char>)
+        {
+            if consteval
+            {
+                if (from >= source.size()) return std::string_view::npos;
+
+                const char* pos = __builtin_char_memchr(source.data() + from, c,
+                    source.size() - from);
+                return pos ? static_cast<size_t>(pos - source.data())
+                    : std::string_view::npos;
+            }
+        }
+#endif
+#endif
+        return source.find(c, from);
+    }
+
+    template <typename CharT>
+    constexpr size_t find_separator(std::basic_string_view<CharT> source,
+        std::basic_string_view<CharT> sep, size_t from)
+    {
+        // Односимвольный разделитель ищется через memchr
+        if (sep.size() == 1) return find_char(source, sep.front(), from);
+        if (sep.empty()) return (from <= source.size()) ? from : std::string_view::npos;
+
+        // Кандидаты -- вхождения первого символа разделителя
+        for (size_t pos = find_char(source, sep.front(), from);
+            pos != std::string_view::npos && pos + sep.size() <= source.size();
+            pos = find_char(source, sep.front(), pos + 1))
+        {
+            if (source.substr(pos, sep.size()) == sep) return pos;
+        }
+        return std::string_view::npos;
+    }
+
+    //=== Пробельные символы ===
+    // Пробел либо один из '\t', '\n', '\v', '\f', '\r', как в isspace
+    template <typename CharT>
+    constexpr bool is_space(const CharT c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+#if defined(__SSE2__)
+    /* Маска пробельных байтов 16-байтового блока: пробел сравнивается
+    напрямую, '\t'..'\r' -- беззнаковым сравнением сдвинутого значения
+    с 4 через min */
+    inline uint32_t space_mask_sse2(const char* block)
+    {
+        const __m128i chunk = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(block));
+        const __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('\t'));
+        const __m128i in_range = _mm_cmpeq_epi8(
+            _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+        const __m128i spaces = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_or_si128(in_range, spaces)));
+    }
+#endif
+
+    /* Позиция первого символа из from, для которого is_space(c) == space,
+    либо размер источника.  Первый символ проверяется сразу: серии
+    пробелов в строках обычно короткие.  Однобайтовые единицы дальше
+    просматриваются по 16 за шаг (SSE2) */
+    template <bool space, typename CharT>
+    constexpr size_t find_space_class(std::basic_string_view<CharT> source,
+        size_t from)
+    {
+        if (from >= source.size()) return source.size();
+        if (is_space(source[from]) == space) return from;
+        ++from;
+
+#if defined(__SSE2__)
+        if constexpr (sizeof(CharT) == 1)
+        {
+            if !consteval
+            {
+                const char* data = reinterpret_cast<const char*>(source.data());
+                for (; from + 16 <= source.size(); from += 16)
+                {
+                    uint32_t mask = space_mask_sse2(data + from);
+                    if constexpr (!space) mask ^= 0xFFFF;
+                    if (mask) return from + std::countr_zero(mask);
+                }
+            }
+        }
+#endif
+        while (from < source.size() && is_space(source[from]) != space) ++from;
+        return from;
+    }
+
+    //=== Точные литералы ===
+    /* Сравнение size кодовых единиц a и b.  Длина известна на этапе
+    компиляции, поэтому во время исполнения сравниваются машинные слова:
+    по 8 байт и перекрывающееся последнее слово, для коротких литералов --
+    два перекрывающихся слова по 4 либо 2 байта */
+    template <size_t size, typename CharT>
+    constexpr bool equal_units(const CharT* a, const CharT* b)
+    {
+        if !consteval
+        {
+            constexpr size_t bytes = size * sizeof(CharT);
+            const char* x = reinterpret_cast<const char*>(a);
+            const char* y = reinterpret_cast<const char*>(b);
+
+            const auto differ = [&]<typename Word>(const size_t at)
+                {
+                    Word u, v;
+                    std::memcpy(&u, x + at, sizeof(Word));
+                    std::memcpy(&v, y + at, sizeof(Word));
+                    return u ^ v;
+                };
+
+            if constexpr (bytes >= 8)
+            {
+                uint64_t diff = differ.template operator()<uint64_t>(bytes - 8);
+                for (size_t at = 0; at + 8 < bytes; at += 8)
+                {
+                    diff |= differ.template operator()<uint64_t>(at);
+                }
+                return !diff;
+            }
+            else if constexpr (bytes >= 4)
+            {
+                return !(differ.template operator()<uint32_t>(0) |
+                    differ.template operator()<uint32_t>(bytes - 4));
+            }
+            else if constexpr (bytes >= 2)
+            {
+                return !(differ.template operator()<uint16_t>(0) |
+                    differ.template operator()<uint16_t>(bytes - 2));
+            }
+            else if constexpr (bytes == 1) return *x == *y;
+            else return true;
+        }
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    //=== Литералы с гибкими пробелами ===
+    /* Сопоставление литерала pattern с источником строго с позиции pos:
+    каждая серия пробельных символов в pattern совпадает с любой
+    непустой серией пробельных символов в источнике, прочие символы --
+    точно.  Возвращает позицию за совпадением либо npos */
+    template <typename CharT>
+    constexpr size_t match_flexible(std::basic_string_view<CharT> source,
+        std::basic_string_view<CharT> pattern, size_t pos)
+    {
+        size_t i = 0;
+        while (i < pattern.size())
+        {
+            if (pos >= source.size()) return std::string_view::npos;
+
+            if (is_space(pattern[i]))
+            {
+                if (!is_space(source[pos])) return std::string_view::npos;
+                i = find_space_class<false>(pattern, i);
+                pos = find_space_class<false>(source, pos);
+                continue;
+            }
+
+            if (source[pos] != pattern[i]) return std::string_view::npos;
+            ++pos;
+            ++i;
+        }
+        return pos;
+    }
+
+    /* Литерал, совпадающий с концом источника: серии пробельных символов
+    сопоставляются как в match_flexible, но справа налево и не левее
+    from.  Возвращает начало совпадения либо npos */
+    template <typename CharT>
+    constexpr size_t match_flexible_back(std::basic_string_view<CharT> source,
+        std::basic_string_view<CharT> pattern, const size_t from)
+    {
+        size_t pos = source.size();
+        size_t i = pattern.size();
+        while (i)
+        {
+            if (pos <= from) return std::string_view::npos;
+
+            if (is_space(pattern[i - 1]))
+            {
+                if (!is_space(source[pos - 1])) return std::string_view::npos;
+                while (i && is_space(pattern[i - 1])) --i;
+                while (pos > from && is_space(source[pos - 1])) --pos;
+                continue;
+            }
+
+            if (source[pos - 1] != pattern[i - 1]) return std::string_view::npos;
+            --pos;
+            --i;
+        }
+        return pos;
+    }
+
+    // Границы найденного литерала: [begin, end)
+    struct literal_match
+    {
+        size_t begin = std::string_view::npos;
+        size_t end = std::string_view::npos;
+    };
+
+    /* Поиск литерала с гибкими пробелами из from.  Кандидаты --
+    вхождения первого непробельного символа литерала; ведущая серия
+    пробелов литерала затем расширяется назад, но не дальше from.
+    Литерал из одних пробелов совпадает с первой серией пробелов */
+    template <typename CharT>
+    constexpr literal_match find_flexible(std::basic_string_view<CharT> source,
+        std::basic_string_view<CharT> pattern, const size_t from)
+    {
+        const size_t anchor = find_space_class<false>(pattern, 0);
+
+        if (anchor == pattern.size())
+        {
+            const size_t begin = find_space_class<true>(source, from);
+            if (begin == source.size()) return {};
+            return { begin, find_space_class<false>(source, begin) };
+        }
+
+        const std::basic_string_view<CharT> rest = pattern.substr(anchor);
+        for (size_t pos = find_char(source, rest.front(), from);
+            pos != std::string_view::npos;
+            pos = find_char(source, rest.front(), pos + 1))
+        {
+            size_t begin = pos;
+            if (anchor)
+            {
+                if (begin == from || !is_space(source[begin - 1])) continue;
+                while (begin > from && is_space(source[begin - 1])) --begin;
+            }
+
+            const size_t end = match_flexible(source, rest, pos);
+            if (end != std::string_view::npos) return { begin, end };
+        }
+        return {};
+    }
+}  // namespace stdx::internals
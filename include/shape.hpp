@@ -0,0 +1,82 @@
+#pragma once
+
+#include "types.hpp"
+#include "format_string.hpp"
+
+#include <string_view>
+
+namespace stdx::internals
+{
+    /* Каноническая форма форматирующей строки: текст перед первым и
+    после последнего плейсхолдеров отбрасывается (источник привязывается
+    к нему до разбора полей), а плейсхолдеры сводятся к {} и {%q} --
+    единственному различию букв, которое видят преобразования во время
+    исполнения.  Остаются последовательность разделителей, режим
+    сопоставления и кодовая единица.
+
+    Форматы одной формы делят одну инстанциацию разбора полей
+    (shape_scanner); проверка типов по буквам и текст вокруг
+    плейсхолдеров остаются в тонкой обёртке каждого формата */
+
+    // Является ли плейсхолдер (позиции '{' и '}') плейсхолдером %q
+    template <format_string format>
+    constexpr bool is_quoted_placeholder(const std::pair<size_t, size_t> pos)
+    {
+        return pos.second - pos.first > 2 &&
+            format.str.data[pos.first + 2] == 'q';
+    }
+
+    // Ёмкость текста формы с учётом ноль-терминатора
+    template <format_string format>
+    consteval size_t get_shape_capacity()
+    {
+        if constexpr (!format.n_placeholders) return 1;
+        else
+        {
+            size_t out = format.placeholder_positions[format.n_placeholders - 1].second + 2 -
+                format.placeholder_positions[0].first;
+            for (const std::pair<size_t, size_t>& pos : format.placeholder_positions)
+            {
+                out -= pos.second - pos.first + 1;
+                out += is_quoted_placeholder<format>(pos) ? 4 : 2;
+            }
+            return out;
+        }
+    }
+
+    template <format_string format>
+    constexpr auto shape_text = []()
+        {
+            using CharT = typename decltype(format)::char_type;
+            constexpr size_t capacity = get_shape_capacity<format>();
+
+            CharT out[capacity]{};
+            size_t n = 0;
+            for (size_t i = 0; i < format.n_placeholders; ++i)
+            {
+                const std::pair<size_t, size_t> pos = format.placeholder_positions[i];
+                out[n++] = '{';
+                if (is_quoted_placeholder<format>(pos))
+                {
+                    out[n++] = '%';
+                    out[n++] = 'q';
+                }
+                out[n++] = '}';
+
+                // Разделитель -- до следующего плейсхолдера
+                const size_t end = i + 1 < format.n_placeholders
+                    ? format.placeholder_positions[i + 1].first
+                    : pos.second + 1;
+                for (size_t j = pos.second + 1; j < end; ++j)
+                {
+                    out[n++] = format.str.data[j];
+                }
+            }
+
+            return basic_fixed_string<CharT, capacity>{ out };
+        }();
+
+    // Форма формата: format_string из текста формы с теми же options
+    template <format_string format>
+    using format_shape = format_string<shape_text<format>, format.options>;
+}  // namespace stdx::internals
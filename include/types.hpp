@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <algorithm>
 
 namespace stdx::internals
@@ -11,6 +12,8 @@ namespace stdx::internals
     template <typename CharT, size_t capacity>
     struct basic_fixed_string
     {
+        using value_type = CharT;
+
         // Хранилище данных
         CharT data[capacity]{};
 
@@ -62,12 +65,45 @@ namespace stdx::internals
     template <size_t size>
     using fixed_wstring = basic_fixed_string<wchar_t, size>;
 
+    template <size_t size>
+    using fixed_u8string = basic_fixed_string<char8_t, size>;
+
+    template <size_t size>
+    using fixed_u16string = basic_fixed_string<char16_t, size>;
+
+    template <size_t size>
+    using fixed_u32string = basic_fixed_string<char32_t, size>;
+
+    // Виды на строки всех поддерживаемых кодовых единиц
+    template <typename T>
+    constexpr bool is_string_view_v = false;
+
+    template <typename CharT>
+    constexpr bool is_string_view_v<std::basic_string_view<CharT>> =
+        std::is_same_v<CharT, char> || std::is_same_v<CharT, wchar_t> ||
+        std::is_same_v<CharT, char8_t> || std::is_same_v<CharT, char16_t> ||
+        std::is_same_v<CharT, char32_t>;
+
     /* Шаблонный класс, хранящий fixed_string 
     достаточной длины для хранения ошибки парсинга */
     constexpr const size_t PARSE_ERR_CAPACITY = 30;
     struct parse_error : fixed_string<PARSE_ERR_CAPACITY>
     {};
 
+    /* Вид на строку допустим, только если он состоит из тех же
+    кодовых единиц, что и форматирующая строка */
+    template <typename T, typename CharT>
+    constexpr bool is_compatible_view_v = !is_string_view_v<std::remove_cv_t<T>> ||
+        std::is_same_v<std::remove_cv_t<T>, std::basic_string_view<CharT>>;
+
+    /* Типы, которые можно считывать и записывать: целочисленные,
+    с плавающей точкой и std::basic_string_view, но не ссылки */
+    template <typename T>
+    constexpr bool is_supported_type_v = !std::is_reference_v<T> &&
+        (std::is_integral_v<T> ||
+        std::is_floating_point_v<T> ||
+        is_string_view_v<std::remove_cv_t<T>>);
+
     // Шаблонный класс для хранения считанных переменных
     template <typename... Args>
     struct scan_result
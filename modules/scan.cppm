@@ -0,0 +1,54 @@
+/* Интерфейс модуля stdx.scan.  Заголовки библиотеки подключаются в
+глобальном фрагменте модуля и разбираются один раз при сборке
+интерфейса; единицы трансляции, выполняющие import stdx.scan,
+получают готовые объявления вместо повторного разбора <tuple>,
+<expected> и шаблонов библиотеки.  Заголовок scan.hpp остаётся
+основным способом подключения для компиляторов и генераторов без
+поддержки модулей */
+module;
+
+#include "scan.hpp"
+
+export module stdx.scan;
+
+export namespace stdx
+{
+    //=== Строки и форматирующие строки ===
+    using stdx::internals::basic_fixed_string;
+    using stdx::internals::fixed_string;
+    using stdx::internals::fixed_wstring;
+    using stdx::internals::fixed_u8string;
+    using stdx::internals::fixed_u16string;
+    using stdx::internals::fixed_u32string;
+    using stdx::internals::format_string;
+    using stdx::internals::format_options;
+    using stdx::internals::parse_error;
+    using stdx::internals::operator""_fs;
+
+    //=== Сканирование ===
+    using stdx::scan;
+    using stdx::scan_all;
+    using stdx::scan_batch;
+    using stdx::internals::scan_result;
+    using stdx::internals::scan_arena;
+    using stdx::internals::scan_error;
+    using stdx::internals::mismatch_reason;
+    using stdx::internals::scanner;
+    using stdx::internals::column_batch;
+    using stdx::internals::compiled_format;
+    using stdx::internals::format_cache;
+    using stdx::internals::field_index;
+    using stdx::internals::packed_record;
+    using stdx::internals::packed_view;
+
+    //=== Инструментирование ===
+    using stdx::internals::no_instrumentation;
+    using stdx::internals::counting_instrumentation;
+    using stdx::internals::scan_counters;
+    using stdx::internals::scan_phase;
+
+    //=== Вывод ===
+    using stdx::max_print_size;
+    using stdx::print_size_bound;
+    using stdx::print_to;
+}  // namespace stdx
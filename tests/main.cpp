@@ -1,5 +1,10 @@
 #include "scan.hpp"
 
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
 constexpr double abs_(double val)
 {
     return val >= 0 ? val : -val;
@@ -426,6 +431,1235 @@ void Scan_Tests()
     */
 }
 
+void Quoted_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    // Классификация: экранирование определяется чётностью серии слэшей
+    {
+        constexpr uint64_t escaped =
+            []()
+            {
+                char block[QUOTE_BLOCK_SIZE]{};
+                constexpr std::string_view text = R"(a\"b\\"c\\\"")";
+                for (size_t i = 0; i < text.size(); ++i) block[i] = text[i];
+
+                uint64_t prev_escaped = 0;
+                const quote_masks masks = classify_block(block, prev_escaped);
+                return masks.quotes & masks.escaped;
+            }();
+        static_assert(escaped == ((1ULL << 2) | (1ULL << 11)));
+    }
+
+    // Серия слэшей на границе 64-байтовых блоков
+    {
+        constexpr quoted_span span =
+            []()
+            {
+                char text[QUOTE_BLOCK_SIZE + 8]{};
+                for (char& c : text) c = 'x';
+                text[0] = '"';
+                text[QUOTE_BLOCK_SIZE] = '\\';
+                text[QUOTE_BLOCK_SIZE + 1] = '"';
+                text[QUOTE_BLOCK_SIZE + 2] = '"';
+                return find_closing_quote({ text, sizeof(text) }, 0);
+            }();
+        static_assert(span.close == QUOTE_BLOCK_SIZE + 2);
+        static_assert(span.has_escapes);
+    }
+
+    // Разделитель внутри кавычек не обрывает значение
+    {
+        constexpr fixed_string source{R"(name="Smith, John", age=42)"};
+        constexpr format_string<"name={%q}, age={%d}"> format;
+
+        constexpr scan_result result = scan<format, source,
+            std::string_view, int>();
+        static_assert(std::get<0>(result.values) == "Smith, John"sv);
+        static_assert(std::get<1>(result.values) == 42);
+    }
+
+    // Значение без экранирования
+    {
+        constexpr fixed_string source{R"("a,b",c)"};
+        constexpr format_string<"{%q},{%s}"> format;
+
+        constexpr std::string_view sv =
+            parse_input<0, format, source, std::string_view>();
+        static_assert(sv == "a,b"sv);
+    }
+
+    // Экранированные кавычки и слэши
+    {
+        constexpr fixed_string source{R"(msg="say \"hi\", \\o/" end)"};
+        constexpr format_string<"msg={%q} end"> format;
+
+        constexpr scan_result result = scan<format, source,
+            std::string_view>();
+        static_assert(std::get<0>(result.values) == R"(say "hi", \o/)"sv);
+    }
+
+    // Значение без кавычек читается как %s
+    {
+        constexpr fixed_string source{"k=plain;"};
+        constexpr format_string<"k={%q};"> format;
+
+        constexpr scan_result result = scan<format, source,
+            std::string_view>();
+        static_assert(std::get<0>(result.values) == "plain"sv);
+    }
+
+    /* Не скомпилируется: нет закрывающей кавычки
+    {
+        constexpr fixed_string source{R"(k="open, 1)"};
+        constexpr format_string<"k={%q}, {%d}"> format;
+        constexpr scan_result result = scan<format, source,
+            std::string_view, int>();
+    }
+    */
+
+    /* Не скомпилируется: %q допустим только для std::string_view
+    {
+        constexpr fixed_string source{R"("1")"};
+        constexpr format_string<"{%q}"> format;
+        constexpr scan_result result = scan<format, source, int>();
+    }
+    */
+}
+
+void Print_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    // Печать в буфер на этапе компиляции
+    constexpr auto print =
+        []<format_string format>(const auto&... values)
+        {
+            std::array<char, 256> out{};
+            const char* end = print_to<format>(out.data(), values...);
+            return std::pair{ out, static_cast<size_t>(end - out.data()) };
+        };
+
+    {
+        constexpr format_string<"id={%d} name={%s} ok"> format;
+        constexpr auto printed = print.template operator()<format>(
+            -1234567, "abc"sv);
+        static_assert(std::string_view{ printed.first.data(), printed.second } ==
+            "id=-1234567 name=abc ok"sv);
+    }
+
+    {
+        constexpr format_string<"{%u}|{}|{%f}|{%f}"> format;
+        constexpr auto printed = print.template operator()<format>(
+            uint64_t{18446744073709551615ull}, int8_t{-128}, 2.5, -1.5e-3);
+        static_assert(std::string_view{ printed.first.data(), printed.second } ==
+            "18446744073709551615|-128|2.5|-1.5e-3"sv);
+    }
+
+    {
+        constexpr format_string<"k={%q};"> format;
+        constexpr auto printed = print.template operator()<format>(
+            R"(say "hi", \o/)"sv);
+        static_assert(std::string_view{ printed.first.data(), printed.second } ==
+            R"(k="say \"hi\", \\o/";)"sv);
+    }
+
+    // Граница длины вывода известна на этапе компиляции
+    {
+        constexpr format_string<"a={%d} b={%f}"> format;
+        static_assert(max_print_size<format, int, double> ==
+            5 + (std::numeric_limits<int>::digits10 + 2) +
+            (std::numeric_limits<double>::max_digits10 + 8));
+        static_assert(print_size_bound<format>(1, 2.0) ==
+            max_print_size<format, int, double>);
+    }
+
+    // Круговая проверка: scan(print_to(values)) == values
+    {
+        constexpr format_string<"some text before {%d} "
+            "more text after {%q} "
+            "and still more text here {%f}"> format;
+        constexpr auto printed = print.template operator()<format>(
+            123456, "MYSTERY, WORD"sv, 3.14159265e-1);
+        constexpr fixed_string<printed.second + 1> source{
+            printed.first.data(), printed.first.data() + printed.second };
+
+        constexpr scan_result result = scan<format, source,
+            int, std::string_view, double>();
+        static_assert(std::get<0>(result.values) == 123456);
+        static_assert(std::get<1>(result.values) == "MYSTERY, WORD"sv);
+        static_assert(abs_(std::get<2>(result.values) - 3.14159265e-1) < 1e-7);
+    }
+
+    /* Не скомпилируется: %d не подходит для double
+    {
+        constexpr format_string<"{%d}"> format;
+        char out[32];
+        print_to<format>(out, 1.0);
+    }
+    */
+}
+
+void Convert_Tests()
+{
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    constexpr auto convert =
+        []<typename T>(std::string_view field, T)
+        {
+            T out{};
+            const std::errc ec = convert_field(field, '\0', out, nullptr);
+            return std::pair{ ec, out };
+        };
+
+    static_assert(convert("1234567890123"sv, int64_t{}) ==
+        std::pair{ std::errc{}, int64_t{1234567890123} });
+    static_assert(convert("-9223372036854775808"sv, int64_t{}).second ==
+        std::numeric_limits<int64_t>::min());
+    static_assert(convert("18446744073709551615"sv, uint64_t{}).second ==
+        std::numeric_limits<uint64_t>::max());
+    static_assert(convert("+00000000000000000042"sv, int{}).second == 42);
+
+    static_assert(convert("18446744073709551616"sv, uint64_t{}).first ==
+        std::errc::result_out_of_range);
+    static_assert(convert("128"sv, int8_t{}).first ==
+        std::errc::result_out_of_range);
+    static_assert(convert("-1"sv, uint8_t{}).first ==
+        std::errc::result_out_of_range);
+    static_assert(convert("12345678x"sv, int{}).first ==
+        std::errc::invalid_argument);
+    static_assert(convert(""sv, int{}).first == std::errc::invalid_argument);
+    static_assert(convert("-"sv, int{}).first == std::errc::invalid_argument);
+
+    static_assert(abs_(convert("+123.456e8"sv, double{}).second - 123.456e8) < 1e-6);
+    static_assert(abs_(convert("-1.0123e-3f"sv, double{}).second + 1.0123e-3) < 1e-9);
+    static_assert(abs_(convert("-1234e"sv, double{}).second + 1234.0) < 1e-9);
+    static_assert(convert("1.2.3"sv, double{}).first == std::errc::invalid_argument);
+    static_assert(convert("+-1"sv, double{}).first == std::errc::invalid_argument);
+
+    // Выход за диапазон -- на этапе компиляции так же, как у std::from_chars
+    static_assert(convert("1e300"sv, float{}).first == std::errc::result_out_of_range);
+    static_assert(convert("1e-300"sv, float{}).first == std::errc::result_out_of_range);
+    static_assert(convert("1e400"sv, double{}).first == std::errc::result_out_of_range);
+    static_assert(convert("0e400"sv, double{}) == std::pair{ std::errc{}, 0.0 });
+
+    /* На этапе компиляции округление корректно, как у std::from_chars:
+    середина между соседними double -- к чётному, субнормальные числа */
+    static_assert(convert("0.1"sv, double{}).second == 0.1);
+    static_assert(convert("1e23"sv, double{}).second == 1e23);
+    static_assert(convert("9007199254740993"sv, double{}).second == 9007199254740992.0);
+    static_assert(convert("9007199254740993.0000000000000000001"sv, double{}).second ==
+        9007199254740994.0);
+    static_assert(convert("16777217"sv, float{}).second == 16777216.0f);
+    static_assert(convert("4.9e-324"sv, double{}).second ==
+        std::numeric_limits<double>::denorm_min());
+    static_assert(convert("2.4703282292062327e-324"sv, double{}).first ==
+        std::errc::result_out_of_range);
+    static_assert(convert("1.7976931348623158e308"sv, double{}).second ==
+        std::numeric_limits<double>::max());
+    static_assert(convert("-inf"sv, double{}).second ==
+        -std::numeric_limits<double>::infinity());
+    static_assert(parse_value<"0.1", double>() == 0.1);
+    static_assert(parse_value<"3.14159", float>() == 3.14159f);
+
+    // Хвост после числа вне диапазона -- ошибка формата
+    {
+        double out = 0;
+        if (convert_float("1e999x"sv, out) != std::errc::invalid_argument ||
+            convert_float(u"1e999x"sv, out) != std::errc::invalid_argument ||
+            convert_float("1e999"sv, out) != std::errc::result_out_of_range)
+        {
+            std::abort();
+        }
+    }
+
+    // Широкое поле сужается в буфер на стеке: длиннее него -- ошибка формата
+    {
+        std::u16string wide(max_wide_float_size - 2, u'0');
+        wide += u"1.5";
+        double out = 0;
+        if (convert_float(std::u16string_view{ wide }.substr(1), out) != std::errc{} ||
+            out != 1.5 ||
+            convert_float(std::u16string_view{ wide }, out) != std::errc::invalid_argument ||
+            convert_float(std::string_view{ std::string(wide.begin(), wide.end()) }, out) !=
+                std::errc{})
+        {
+            std::abort();
+        }
+    }
+}
+
+void Runtime_Scan_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"some text before {%d} "
+        "more text after {%s} "
+        "and still more text here {%f}"> format;
+
+    // Источник -- обычный std::string_view, а не параметр шаблона
+    {
+        constexpr std::expected result = scan<format, int,
+            std::string_view, double>("some text before 123456 "
+                "more text after MYSTERY WORD "
+                "and still more text here 3.14159265e-1"sv);
+        static_assert(result.has_value());
+        static_assert(std::get<0>(result->values) == 123456);
+        static_assert(std::get<1>(result->values) == "MYSTERY WORD"sv);
+        static_assert(abs_(std::get<2>(result->values) - 3.14159265e-1) < 1e-9);
+    }
+
+    // Ошибка преобразования -- не ошибка компиляции, а пустой результат
+    {
+        constexpr std::expected result = scan<format, int,
+            std::string_view, double>("some text before 12x456 "
+                "more text after MYSTERY WORD "
+                "and still more text here 3.14159265e-1"sv);
+        static_assert(!result.has_value());
+    }
+
+    // %q: без арены разэкранировать значение некуда
+    {
+        constexpr format_string<"k={%q};"> quoted;
+        static_assert(scan<quoted, std::string_view>(R"(k="a;b";)"sv));
+        static_assert(!scan<quoted, std::string_view>(R"(k="a\"b";)"sv));
+        static_assert(!scan<quoted, std::string_view>(R"(k="a;b)"sv));
+
+        constexpr bool unescaped =
+            [&]()
+            {
+                scan_arena arena{8};
+                const std::expected result = scan<quoted, std::string_view>(
+                    R"(k="say \"hi\", \\o/";)"sv, &arena);
+                return result &&
+                    std::get<0>(result->values) == R"(say "hi", \o/)"sv;
+            }();
+        static_assert(unescaped);
+    }
+
+    // Круговая проверка во время исполнения
+    {
+        char buffer[max_print_size<format, int, double> + 16];
+        char* end = print_to<format>(buffer, -42, "WORD"sv, 0.1 + 0.2);
+        const std::expected result = scan<format, int, std::string_view,
+            double>({ buffer, static_cast<size_t>(end - buffer) });
+
+        if (!result || std::get<0>(result->values) != -42 ||
+            std::get<1>(result->values) != "WORD"sv ||
+            std::get<2>(result->values) != 0.1 + 0.2)
+        {
+            std::abort();
+        }
+    }
+}
+
+void Compiled_Format_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    static_assert(compiled_format::compile("a={%d}, b={%q}, c={}"sv));
+    static_assert(!compiled_format::compile("{"sv));
+    static_assert(!compiled_format::compile("}"sv));
+    static_assert(!compiled_format::compile("{{}}"sv));
+    static_assert(!compiled_format::compile("{%x}"sv));
+
+    static_assert(
+        []()
+        {
+            const auto format = compiled_format::compile(
+                "id={%u} name={%q} score={%f}"sv);
+            const std::expected result = format->scan<unsigned,
+                std::string_view, double>(
+                    R"(id=7 name="Smith, John" score=-2.5e1)"sv);
+
+            return format->n_placeholders() == 3 && result &&
+                std::get<0>(result->values) == 7 &&
+                std::get<1>(result->values) == "Smith, John"sv &&
+                std::get<2>(result->values) == -25.0;
+        }());
+
+    // Типы проверяются во время исполнения
+    static_assert(
+        []()
+        {
+            const auto format = compiled_format::compile("{%u} {%s}"sv);
+            return !format->accepts<int, std::string_view>() &&
+                !format->accepts<unsigned>() &&
+                format->accepts<unsigned, std::string_view>() &&
+                !format->scan<int, std::string_view>("1 a"sv);
+        }());
+
+    // Кэш: повторный запрос возвращает тот же скомпилированный формат
+    {
+        format_cache cache{2};
+        const auto a = cache.get("{%d};{%d}");
+        const auto b = cache.get(std::string{"{%d};{%d}"});
+        const auto c = cache.get("{%d}|{%d}");
+        const auto d = cache.get("{%d}:{%d}");
+        const auto bad = cache.get("{%d");
+
+        if (!a || !b || *a != *b || !c || !d || bad || cache.size() != 2 ||
+            !(*d)->scan<int, int>("1:2"sv))
+        {
+            std::abort();
+        }
+    }
+}
+
+void Scan_All_Tests()
+{
+    using namespace stdx;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"{%s},{%u},{%f}"> format;
+
+    // Источник -- со статическим временем жизни, как и данные из #embed
+    static constexpr fixed_string table{
+        "alpha,1,0.5\n"
+        "beta,22,-1.25\r\n"
+        "\n"
+        "gamma,333,1e3"};
+
+    constexpr auto records = scan_all<format, table,
+        std::string_view, unsigned, double>();
+    static_assert(records.size() == 3);
+    static_assert(std::get<0>(records[0].values) == "alpha"sv);
+    static_assert(std::get<2>(records[1].values) == -1.25);
+    static_assert(std::get<1>(records[2].values) == 333);
+
+    static constexpr char lines[] = "1\n2\n3\n";
+    constexpr format_string<"{%d}"> number;
+    static_assert(scan_all<number, lines, int>().size() == 3);
+    static_assert(std::get<0>(scan_all<number, lines, int>()[2].values) == 3);
+
+    // Не скомпилируется: вторая запись не совпадает с форматом
+    // static constexpr char bad[] = "1\nx\n";
+    // constexpr auto fail = scan_all<number, bad, int>();
+}
+
+void Field_Index_Tests()
+{
+    using namespace stdx;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"[{%u}] {%s}: {%q};"> format;
+
+    const std::string_view file =
+        "[1] info: \"started\";\n"
+        "[2] warn: \"disk, \\\"almost\\\" full\";\n"
+        "broken line\n"
+        "[3] error: \"stopped\";\n"
+        "[4] debug: \"unterminated;\n"sv;
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "scan_field_index.scix").string();
+
+    const field_index<format> built = field_index<format>::build(file);
+    if (built.save(path.c_str()) != std::errc{}) std::abort();
+
+    const std::expected loaded = field_index<format>::load(path.c_str(), file);
+    const std::expected other = field_index<format>::load(path.c_str(),
+        "[1] info: \"started\";\n"sv);
+    const std::expected missing = field_index<format>::load("", file);
+
+    scan_arena arena;
+    const std::optional record = loaded
+        ? loaded->scan<unsigned, std::string_view, std::string_view>(1, &arena)
+        : std::nullopt;
+
+    if (!loaded || other || missing ||
+        other.error() != std::errc::invalid_argument ||
+        loaded->size() != 5 || loaded->matched(4) || !loaded->matched(3) ||
+        loaded->field<1>(3) != "error"sv ||
+        loaded->get<0, unsigned>(3) != 3u ||
+        loaded->get<0, unsigned>(2) ||
+        !record || std::get<0>(record->values) != 2 ||
+        std::get<2>(record->values) != R"(disk, "almost" full)"sv)
+    {
+        std::abort();
+    }
+
+    /* Испорченный поток полей при верных хэшах: незавершённые числа
+    и поля за пределами файла отсекаются при загрузке */
+    const auto corrupt = [&](const char fill)
+        {
+            std::string image;
+            {
+                std::ifstream in{ path, std::ios::binary };
+                image.assign(std::istreambuf_iterator<char>{ in }, {});
+            }
+
+            stdx::internals::index_header header;
+            std::memcpy(&header, image.data(), sizeof(header));
+            std::fill(image.end() - header.data_size, image.end(), fill);
+
+            const std::string corrupted = path + ".corrupt";
+            std::ofstream{ corrupted, std::ios::binary } << image;
+            const std::expected out = field_index<format>::load(corrupted.c_str(), file);
+            std::filesystem::remove(corrupted);
+            return out;
+        };
+
+    for (const char fill : { '\xff', '\x7f' })
+    {
+        const std::expected broken = corrupt(fill);
+        if (broken || broken.error() != std::errc::invalid_argument) std::abort();
+    }
+
+    std::filesystem::remove(path);
+}
+
+void Batch_Tests()
+{
+    using namespace stdx;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"{%d};{%u};{%f};{%s}"> format;
+
+    // Этап преобразования по столбцам даёт те же значения, что и scan
+    static_assert(
+        [&]()
+        {
+            constexpr std::string_view records[] = {
+                "-12;7;0.25;a"sv,
+                "+3;12345678901234567890;-1.5e3;b"sv,
+                "1;2;1.5f;c"sv,
+                "x;1;1.0;d"sv,
+                "1;-1;1.0;e"sv };
+
+            const auto batch = scan_batch<format, int, uint64_t,
+                double, std::string_view>(records);
+
+            return batch.size() == 5 &&
+                batch.valid == std::vector<uint8_t>{ 1, 1, 1, 0, 0 } &&
+                batch.column<0>()[0] == -12 && batch.column<0>()[1] == 3 &&
+                batch.column<1>()[1] == 12345678901234567890ULL &&
+                batch.column<2>()[0] == 0.25 &&
+                batch.column<2>()[1] == -1500.0 &&
+                batch.column<2>()[2] == 1.5 &&
+                batch.column<3>()[2] == "c"sv;
+        }());
+
+    // Векторные ядра во время исполнения: сверка со scan на случайных записях
+    {
+        std::vector<std::string> lines;
+        uint64_t state = 42;
+        const auto next = [&]()
+            {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                return state >> 33;
+            };
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const int64_t whole = static_cast<int64_t>(next() % 2'000'000'000) - 1'000'000'000;
+            lines.push_back(std::to_string(whole) + ";" +
+                std::to_string(next() * next()) + ";" +
+                std::to_string(whole / 1000) + "." + std::to_string(next() % 1000) + ";" +
+                ((i % 97) ? "w" : "x;y"));
+        }
+        lines.push_back("99999999999;1;1;w");
+
+        const std::vector<std::string_view> records(lines.begin(), lines.end());
+        const auto batch = scan_batch<format, int, uint64_t, double,
+            std::string_view>(records);
+
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const std::expected result = scan<format, int, uint64_t, double,
+                std::string_view>(records[i]);
+
+            if (batch.valid[i] != result.has_value() || (result &&
+                (std::get<0>(result->values) != batch.column<0>()[i] ||
+                std::get<1>(result->values) != batch.column<1>()[i] ||
+                std::get<2>(result->values) != batch.column<2>()[i] ||
+                std::get<3>(result->values) != batch.column<3>()[i])))
+            {
+                std::abort();
+            }
+        }
+    }
+
+    // Признаки строк из маски сравнения: по байту на 16-битную группу
+    static_assert(stdx::internals::get_row_flags(~0ULL) == 0x0101'0101u);
+    static_assert(stdx::internals::get_row_flags(0xFFFF'7FFF'FFFF'FFFEULL) == 0x0100'0100u);
+    static_assert(stdx::internals::get_row_flags(0x0000'FFFF'0000'0000ULL) == 0x0001'0000u);
+
+    /* Этапы -- только при трети и более полей с плавающей точкой или
+    64-битных целых; прочие форматы сканируются по записям */
+    static_assert(stdx::internals::prefers_columns<int, uint64_t, double, std::string_view>());
+    static_assert(!stdx::internals::prefers_columns<std::string_view, int, unsigned, int>());
+
+    {
+        constexpr format_string<"id={%d} shard={%u} user={%s}"> short_format;
+        const std::string_view records[] = {
+            "id=-7 shard=3 user=ann"sv,
+            "id=x shard=3 user=bob"sv,
+            "id=12 shard=65536 user=cy"sv };
+
+        // Повторно используемые столбцы дают те же значения
+        column_batch<int, unsigned, std::string_view> reused;
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            scan_batch<short_format, int, unsigned, std::string_view>(records, reused);
+            if (reused.valid != std::vector<uint8_t>{ 1, 0, 1 } ||
+                reused.column<0>()[0] != -7 || reused.column<1>()[2] != 65536u ||
+                reused.column<2>()[2] != "cy"sv)
+            {
+                std::abort();
+            }
+        }
+    }
+}
+
+void Instrumentation_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"id={%u} t={%f}"> format;
+    using counting = scanner<format, counting_instrumentation<true>>;
+
+    // На этапе компиляции обработчики не вызываются
+    static_assert(counting::scan<unsigned, double>("id=1 t=2.5"sv));
+
+    /* Не const: константная инициализация вычислялась бы
+    на этапе компиляции, без обработчиков */
+    counting_instrumentation<true>::reset();
+    bool ok = counting::scan<unsigned, double>("id=1 t=2.5"sv) &&
+        !counting::scan<unsigned, double>("id=-1 t=2.5"sv) &&
+        !counting::scan<unsigned, double>("id=1 t=x"sv) &&
+        !counting::scan<unsigned, double>("id=99999999999 t=1"sv);
+
+    const std::optional c =
+        counting_instrumentation<true>::snapshot("id={%u} t={%f}"sv);
+
+    if (!ok || !c || c->records != 4 || c->matches != 1 ||
+        c->bytes != 10 + 11 + 8 + 18 ||
+        c->mismatch_count(mismatch_reason::invalid_value) != 1 ||
+        c->mismatch_count(mismatch_reason::out_of_range) != 2 ||
+        c->conversion_failures != std::vector<uint64_t>{ 2, 1 } ||
+        !counting_instrumentation<true>::snapshot<format>() ||
+        counting_instrumentation<true>::snapshot("{%u}"sv))
+    {
+        std::abort();
+    }
+}
+
+void Wide_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    // На этапе компиляции: источник -- из тех же кодовых единиц, что и формат
+    {
+        constexpr format_string<u"x={%d}, имя={%s}; v={%f}"> format;
+        static_assert(format.n_placeholders == 3);
+
+        constexpr scan_result result = scan<format,
+            u"x=-42, имя=Привет; v=1.5e2", int, std::u16string_view, double>();
+        static_assert(std::get<0>(result.values) == -42);
+        static_assert(std::get<1>(result.values) == u"Привет"sv);
+        static_assert(abs_(std::get<2>(result.values) - 150) < 1e-9);
+    }
+
+    {
+        constexpr format_string<u8"{%u}:{%q}"> format;
+        constexpr scan_result result = scan<format,
+            u8"7:\"a\\tb\"", unsigned, std::u8string_view>();
+        static_assert(std::get<0>(result.values) == 7);
+        static_assert(std::get<1>(result.values) == u8"a\tb"sv);
+
+        constexpr scan_result wide = scan<format_string<L"{}|{}">{},
+            L"12|ёж", int, std::wstring_view>();
+        static_assert(std::get<0>(wide.values) == 12);
+        static_assert(std::get<1>(wide.values) == L"ёж"sv);
+
+        constexpr scan_result utf32 = scan<format_string<U"{%f} 🙂 {%d}">{},
+            U"-0.25 🙂 +17", float, int>();
+        static_assert(std::get<0>(utf32.values) == -0.25f);
+        static_assert(std::get<1>(utf32.values) == 17);
+    }
+
+    // Во время исполнения -- те же ядра, что и на этапе компиляции
+    {
+        constexpr format_string<u"id={%u}; name={%s}; t={%f}"> format;
+        static_assert(scan<format, unsigned, std::u16string_view, double>(
+            u"id=123456789; name=Жук; t=0.5"sv));
+        static_assert(!scan<format, unsigned, std::u16string_view, double>(
+            u"id=12x; name=Жук; t=0.5"sv));
+
+        // Длинные поля проходят векторный поиск и поблочное преобразование
+        std::u16string source = u"id=18446744073709551615; name=";
+        source.append(100, u'ы');
+        source += u"; t=-1234.5678e-3";
+
+        const std::expected result =
+            scan<format, uint64_t, std::u16string_view, double>(source);
+        if (!result || std::get<0>(result->values) != 18446744073709551615ULL ||
+            std::get<1>(result->values) != std::u16string(100, u'ы') ||
+            std::get<2>(result->values) != -1.2345678)
+        {
+            std::abort();
+        }
+
+        // Не-ASCII в числе и переполнение -- несовпадение
+        if (scan<format, uint64_t, std::u16string_view, double>(
+                u"id=18446744073709551616; name=; t=1"sv) ||
+            scan<format, uint64_t, std::u16string_view, double>(
+                u"id=1; name=; t=1.５"sv))
+        {
+            std::abort();
+        }
+    }
+
+    // Разэкранирование широкой строки в арену
+    {
+        constexpr format_string<U"k={%q};"> format;
+
+        scan_arena arena;
+        const std::expected result = scan<format, std::u32string_view>(
+            U"k=\"say \\\"привет\\\"; \\n\";"sv, &arena);
+        if (!result || std::get<0>(result->values) != U"say \"привет\"; \n"sv)
+        {
+            std::abort();
+        }
+    }
+
+    // Двухбайтовое ядро цифр совпадает с однобайтовым
+    for (uint64_t value = 1, i = 0; i < 64; ++i, value = value * 3 + i)
+    {
+        const std::string digits = std::to_string(value);
+        const std::u16string wide(digits.begin(), digits.end());
+
+        uint64_t narrow_out = 0, wide_out = 0;
+        if (convert_integer(std::string_view{ digits }, narrow_out) != std::errc{} ||
+            convert_integer(std::u16string_view{ wide }, wide_out) != std::errc{} ||
+            narrow_out != wide_out)
+        {
+            std::abort();
+        }
+    }
+
+    // Не скомпилируется: источник и формат из разных кодовых единиц
+    // scan<format_string<u"{}">{}, "1", int>();
+
+    // Не скомпилируется: вид на строку другого типа
+    // scan<format_string<u"{%s}">{}, std::string_view>(u"abc"sv);
+}
+
+void Flexible_Whitespace_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"x = {%d} ,\t{%s} end",
+        format_options::flexible_whitespace> format;
+
+    // Гибко сопоставляются только литералы с пробельными символами
+    {
+        constexpr format_string<"{%d},{%d} {%d}",
+            format_options::flexible_whitespace> mixed;
+        static_assert(!is_flexible_literal<mixed>(get_separator_after<0, mixed>()));
+        static_assert(is_flexible_literal<mixed>(get_separator_after<1, mixed>()));
+
+        constexpr format_string<"{%d} {%d}"> exact;
+        static_assert(!is_flexible_literal<exact>(get_separator_after<0, exact>()));
+    }
+
+    // На этапе компиляции
+    {
+        constexpr scan_result result = scan<format,
+            "x\t=   42 ,  hello world \t end", int, std::string_view>();
+        static_assert(std::get<0>(result.values) == 42);
+        static_assert(std::get<1>(result.values) == "hello world"sv);
+
+        constexpr format_string<"{%d} {%d}",
+            format_options::flexible_whitespace> columns;
+        constexpr scan_result pair = scan<columns, "12 \t  34", int, int>();
+        static_assert(std::get<0>(pair.values) == 12);
+        static_assert(std::get<1>(pair.values) == 34);
+    }
+
+    // Во время исполнения
+    {
+        static_assert(scan<format, int, std::string_view>(
+            "x = 1 ,\ta end"sv));
+
+        // Серия пробелов формата требует хотя бы одного пробела в источнике
+        static_assert(!scan<format, int, std::string_view>("x= 1 , a end"sv));
+        static_assert(!scan<format, int, std::string_view>("y = 1 , a end"sv));
+
+        // Длинные серии пропускаются блоками по 16 байт
+        std::string line = "x";
+        line.append(40, ' ');
+        line += "=\t\t-7";
+        line.append(33, '\t');
+        line += ",\r\n  \v\f  value with  spaces";
+        line.append(20, ' ');
+        line += "end";
+
+        const std::expected result = scan<format, int, std::string_view>(line);
+        if (!result || std::get<0>(result->values) != -7 ||
+            std::get<1>(result->values) != "value with  spaces"sv)
+        {
+            std::abort();
+        }
+    }
+
+    // Пакетное сканирование и индекс полей используют те же литералы
+    {
+        const std::string_view records[] = {
+            "x  = 10 , first end"sv,
+            "x\t=\t20\t,\tsecond\tend"sv,
+            "x=30, bad end"sv,
+        };
+
+        const column_batch batch = scan_batch<format, int, std::string_view>(records);
+        if (batch.valid != std::vector<uint8_t>{ 1, 1, 0 } ||
+            batch.column<0>()[1] != 20 || batch.column<1>()[0] != "first"sv ||
+            batch.column<1>()[1] != "second"sv)
+        {
+            std::abort();
+        }
+    }
+
+    // Векторный поиск класса совпадает с посимвольным
+    std::string sample;
+    for (uint32_t state = 1, i = 0; i < 512; ++i)
+    {
+        state = state * 1'103'515'245 + 12'345;
+        constexpr char alphabet[] = { ' ', '\t', '\n', '\r', '\v', '\f',
+            'a', '\x08', '\x0e', '\x89', '\xa0', '!' };
+        sample += alphabet[(state >> 16) % sizeof(alphabet)];
+    }
+
+    for (size_t from = 0; from <= sample.size(); ++from)
+    {
+        size_t space = from, other = from;
+        while (space < sample.size() && !is_space(sample[space])) ++space;
+        while (other < sample.size() && is_space(sample[other])) ++other;
+
+        if (find_space_class<true>(std::string_view{ sample }, from) != space ||
+            find_space_class<false>(std::string_view{ sample }, from) != other)
+        {
+            std::abort();
+        }
+    }
+}
+
+void Scan_Error_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    static_assert(sizeof(scan_error) <= 16);
+
+    constexpr format_string<"id={%u} name={%q} t={%f}"> format;
+    using result_t = std::expected<scan_result<unsigned, std::string_view, double>,
+        scan_error>;
+
+    // Ошибка указывает причину, плейсхолдер и начало поля
+    {
+        constexpr result_t ok = scan<format, unsigned, std::string_view, double>(
+            "id=1 name=\"x\" t=2.5"sv);
+        static_assert(ok.has_value());
+
+        constexpr result_t bad_value = scan<format, unsigned, std::string_view,
+            double>("id=1 name=x t=2.5.1"sv);
+        static_assert(bad_value.error() ==
+            scan_error{ 14, 2, mismatch_reason::invalid_value });
+
+        constexpr result_t overflow = scan<format, unsigned, std::string_view,
+            double>("id=99999999999 name=x t=1"sv);
+        static_assert(overflow.error() ==
+            scan_error{ 3, 0, mismatch_reason::out_of_range });
+
+        constexpr result_t unclosed = scan<format, unsigned, std::string_view,
+            double>("id=7 name=\"abc t=1"sv);
+        static_assert(unclosed.error() ==
+            scan_error{ 10, 1, mismatch_reason::unclosed_quote });
+
+        constexpr result_t no_arena = scan<format, unsigned, std::string_view,
+            double>("id=7 name=\"a\\\"b\" t=1"sv);
+        static_assert(no_arena.error().code == mismatch_reason::no_arena);
+    }
+
+    /* Несовпадение текста формата: короткий источник -- его конец,
+    текст перед первым плейсхолдером -- начало, после последнего --
+    место этого текста и последний плейсхолдер */
+    {
+        constexpr format_string<"x={} y={}!"> anchored;
+        static_assert(scan<anchored, int, int>("x=1"sv).error() ==
+            scan_error{ 3, 0, mismatch_reason::literal_mismatch });
+        static_assert(scan<anchored, int, int>("z=1 y=2!"sv).error() ==
+            scan_error{ 0, 0, mismatch_reason::literal_mismatch });
+        static_assert(scan<anchored, int, int>("x=1 y=2?"sv).error() ==
+            scan_error{ 7, 1, mismatch_reason::literal_mismatch });
+
+        const std::expected compiled = compiled_format::compile("x={} y={}!"sv);
+        if (!compiled ||
+            compiled->scan<int, int>("x=1"sv).error() !=
+                scan_error{ 3, 0, mismatch_reason::literal_mismatch } ||
+            compiled->scan<int, int>("z=1 y=2!"sv).error() !=
+                scan_error{ 0, 0, mismatch_reason::literal_mismatch } ||
+            compiled->scan<int, int>("x=1 y=2?"sv).error() !=
+                scan_error{ 7, 1, mismatch_reason::literal_mismatch })
+        {
+            std::abort();
+        }
+    }
+
+    // Текст перед первым плейсхолдером с гибкими пробелами
+    {
+        constexpr format_string<"id = {%u}",
+            format_options::flexible_whitespace> flexible;
+        static_assert(scan<flexible, unsigned>("ix = 1"sv).error() ==
+            scan_error{ 0, 0, mismatch_reason::literal_mismatch });
+    }
+
+    // Форматирующая строка времени исполнения
+    {
+        const std::expected format = compiled_format::compile("{%d};{%d}"sv);
+        if (!format) std::abort();
+
+        const std::expected types = format->scan<int, unsigned>("1;2"sv);
+        const std::expected value = format->scan<int, int>("1;x2"sv);
+
+        if (types || types.error().code != mismatch_reason::type_mismatch ||
+            value || value.error() != scan_error{ 2, 1, mismatch_reason::invalid_value })
+        {
+            std::abort();
+        }
+    }
+}
+
+void Shape_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    constexpr format_string<"id={%d}, name={%s}"> id_format;
+    constexpr format_string<"key: {%u}, name={}"> key_format;
+
+    // Текст перед первым плейсхолдером и буквы, кроме %q, отбрасываются
+    {
+        static_assert(shape_text<id_format>.sv() == "{}, name={}"sv);
+        static_assert(std::is_same_v<format_shape<id_format>,
+            format_shape<key_format>>);
+
+        constexpr format_string<"{%q}|{%f}"> quoted;
+        static_assert(shape_text<quoted>.sv() == "{%q}|{}"sv);
+
+        constexpr format_string<"no placeholders"> empty;
+        static_assert(shape_text<empty>.sv().empty());
+
+        constexpr format_string<u"x={%d};y={%d}"> wide;
+        static_assert(shape_text<wide>.sv() == u"{};y={}"sv);
+    }
+
+    // Разделители, %q и режим сопоставления различают формы
+    {
+        constexpr format_string<"id={%d}; name={%s}"> other_sep;
+        constexpr format_string<"id={%d}, name={%q}"> other_spec;
+        constexpr format_string<"id={%d}, name={%s}",
+            format_options::flexible_whitespace> other_options;
+
+        static_assert(!std::is_same_v<format_shape<id_format>,
+            format_shape<other_sep>>);
+        static_assert(!std::is_same_v<format_shape<id_format>,
+            format_shape<other_spec>>);
+        static_assert(!std::is_same_v<format_shape<id_format>,
+            format_shape<other_options>>);
+    }
+
+    // Форматы одной формы сканируют и проверяют текст независимо
+    {
+        constexpr auto id = scan<id_format, int, std::string_view>(
+            "id=-5, name=alice"sv);
+        constexpr auto key = scan<key_format, unsigned, std::string_view>(
+            "key: 7, name=bob"sv);
+        static_assert(std::get<0>(id->values) == -5 && std::get<1>(id->values) == "alice");
+        static_assert(std::get<0>(key->values) == 7 && std::get<1>(key->values) == "bob");
+
+        constexpr format_string<"id  = {%d}, name={%s}",
+            format_options::flexible_whitespace> flexible;
+        static_assert(scan<flexible, int, std::string_view>(
+            "id=1, name=x"sv).error().code == mismatch_reason::literal_mismatch);
+    }
+
+    // Счётчики инструментирования остаются отдельными для каждого формата
+    {
+        using counting = counting_instrumentation<true>;
+        counting::reset();
+
+        std::string source = "id=1, name=a";
+        const auto id = scanner<id_format, counting>::scan<int, std::string_view>(source);
+        source = "key: 2, name=b";
+        const auto key = scanner<key_format, counting>::scan<unsigned, std::string_view>(source);
+        source = "key: x, name=b";
+        const auto bad = scanner<key_format, counting>::scan<unsigned, std::string_view>(source);
+
+        const std::optional<scan_counters> id_counters = counting::snapshot<id_format>();
+        const std::optional<scan_counters> key_counters = counting::snapshot<key_format>();
+        if (!id || !key || bad || !id_counters || !key_counters ||
+            id_counters->records != 1 || id_counters->matches != 1 ||
+            key_counters->records != 2 || key_counters->matches != 1 ||
+            key_counters->conversion_failures[0] != 1)
+        {
+            std::abort();
+        }
+    }
+}
+
+template <typename Record, size_t I>
+concept reads_without_base = requires(const Record& record) { record.template get<I>(); };
+
+template <typename Record>
+concept unpacks_without_base = requires(const Record& record) { record.unpack(); };
+
+void Packed_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    // Поля переставляются по убыванию выравнивания, виды сжимаются
+    {
+        using record = packed_record<int8_t, double, std::string_view, int8_t>;
+        static_assert(get_packed_order<int8_t, double, std::string_view, int8_t>() ==
+            std::array<size_t, 4>{ 1, 2, 0, 3 });
+        static_assert(sizeof(record) == 24);
+        static_assert(sizeof(record) <
+            sizeof(scan_result<int8_t, double, std::string_view, int8_t>));
+
+        static_assert(sizeof(packed_record<uint16_t, uint64_t, uint16_t, uint32_t>) == 16);
+        static_assert(sizeof(packed_record<std::string_view, std::string_view>) == 16);
+    }
+
+    // get<I> сохраняет порядок плейсхолдеров
+    {
+        constexpr std::string_view source = "id=-3 name=alice t=2.5 ok=1"sv;
+        constexpr auto result = scan<format_string<"id={%d} name={%s} t={%f} ok={%u}">{},
+            int8_t, std::string_view, double, uint8_t>(source);
+
+        using record = packed_record<int8_t, std::string_view, double, uint8_t>;
+        constexpr std::optional<record> packed = record::pack(*result, source);
+        static_assert(packed.has_value());
+        static_assert(packed->get<0>() == -3);
+        static_assert(packed->get<1>(source) == "alice"sv);
+        static_assert(packed->get<2>() == 2.5);
+        static_assert(packed->get<3>() == 1);
+
+        constexpr scan_result<int8_t, std::string_view, double, uint8_t> unpacked =
+            packed->unpack(source);
+        static_assert(unpacked.values == result->values);
+
+        // Без базы вид на строку не читается
+        static_assert(!record::is_view_field<0>() && record::is_view_field<1>());
+        static_assert(!reads_without_base<record, 1> && reads_without_base<record, 2>);
+        static_assert(!unpacks_without_base<record>);
+    }
+
+    // Запись без видов распаковывается без базы
+    {
+        constexpr auto result = scan<format_string<"{%d}:{%f}">{}, int, float>("4:0.5"sv);
+
+        using record = packed_record<int, float>;
+        constexpr std::optional<record> packed = record::pack(*result, {});
+        static_assert(unpacks_without_base<record>);
+        static_assert(packed->unpack().values == result->values);
+        static_assert(packed->get<0>() == 4 && packed->get<1>({}) == 0.5f);
+    }
+
+    // Вид вне базы пакета не упаковывается
+    {
+        const std::string base = "name=alice";
+        const std::string other = "bob";
+        const scan_result<std::string_view, int> inside{ std::string_view{ base }.substr(5), 1 };
+        const scan_result<std::string_view, int> outside{ std::string_view{ other }, 1 };
+        const scan_result<std::string_view, int> empty{ std::string_view{}, 2 };
+
+        using record = packed_record<std::string_view, int>;
+        const std::optional<record> ok = record::pack(inside, base);
+        if (!ok || ok->get<0>(base) != "alice" || ok->get<1>() != 1 ||
+            record::pack(outside, base) ||
+            !record::pack(empty, base) || !record::pack(empty, base)->get<0>(base).empty())
+        {
+            std::abort();
+        }
+    }
+
+    // Широкие строки
+    {
+        constexpr std::u16string_view source = u"k=v;n=7"sv;
+        constexpr auto result = scan<format_string<u"k={};n={%d}">{},
+            std::u16string_view, int>(source);
+
+        using record = packed_record<std::u16string_view, int>;
+        static_assert(std::is_same_v<record::char_type, char16_t>);
+        constexpr std::optional<record> packed = record::pack(*result, source);
+        static_assert(packed->get<0>(source) == u"v"sv && packed->get<1>() == 7);
+    }
+}
+
+void Anchoring_Tests()
+{
+    using namespace stdx;
+    using namespace stdx::internals;
+    using namespace std::string_view_literals;
+
+    // Наименьшая длина источника -- сумма литералов
+    {
+        static_assert(get_min_source_size<format_string<"id={%d}, t={%f} ms">{}>() == 10);
+        static_assert(get_min_source_size<format_string<"{}{}">{}>() == 0);
+        static_assert(get_min_source_size<format_string<"id  =\t{%d} ,x",
+            format_options::flexible_whitespace>{}>() == 8);
+    }
+
+    // Сравнение словами совпадает с посимвольным
+    {
+        const std::string a = "0123456789abcdefghij";
+        bool ok = true;
+        [&]<size_t... N>(std::index_sequence<N...>)
+        {
+            (..., [&]()
+                {
+                    std::string b = a;
+                    ok = ok && equal_units<N>(a.data(), b.data());
+                    if constexpr (N > 0)
+                    {
+                        b[N - 1] = '#';
+                        ok = ok && !equal_units<N>(a.data(), b.data());
+                        b = a;
+                        b[0] = '#';
+                        ok = ok && !equal_units<N>(a.data(), b.data());
+                    }
+                }());
+        }(std::make_index_sequence<21>{});
+
+        const std::u16string w = u"abcdefgh";
+        const std::u16string v = u"abcdefgX";
+        if (!ok || !equal_units<7>(w.data(), v.data()) ||
+            equal_units<8>(w.data(), v.data()))
+        {
+            std::abort();
+        }
+    }
+
+    // Текст перед первым и после последнего плейсхолдеров проверяется
+    {
+        constexpr format_string<"id={%d}, t={%f} ms"> format;
+        using result_t = std::expected<scan_result<int, double>, scan_error>;
+
+        constexpr result_t ok = scan<format, int, double>("id=1, t=2.5 ms"sv);
+        static_assert(ok && std::get<1>(ok->values) == 2.5);
+
+        constexpr mismatch_reason literal = mismatch_reason::literal_mismatch;
+        static_assert(scan<format, int, double>("ID=1, t=2.5 ms"sv).error() ==
+            scan_error{ 0, 0, literal });
+        static_assert(scan<format, int, double>("id=1, t=2.5 s"sv).error() ==
+            scan_error{ 10, 1, literal });
+        static_assert(scan<format, int, double>("id=1, t=2.5 ms "sv).error() ==
+            scan_error{ 12, 1, literal });
+        static_assert(scan<format, int, double>("id="sv).error() ==
+            scan_error{ 3, 0, literal });
+
+        // Ненайденный разделитель -- несовпадение, а не поле до конца строки
+        static_assert(scan<format, int, double>("id=1; t=2.5 ms"sv).error() ==
+            scan_error{ 3, 0, mismatch_reason::literal_mismatch });
+    }
+
+    // Последнее поле тянется до текста после него, а не до первого вхождения
+    {
+        constexpr format_string<"[{}];"> format;
+        static_assert(std::get<0>(scan<format, std::string_view>(
+            "[a];[b];"sv)->values) == "a];[b"sv);
+        static_assert(std::get<0>(scan<format, std::string_view>(
+            "[];"sv)->values).empty());
+        static_assert(!scan<format, std::string_view>("[;"sv));
+
+        constexpr format_string<"{%q};"> quoted;
+        static_assert(scan<quoted, std::string_view>("\"a;"sv).error().code ==
+            mismatch_reason::unclosed_quote);
+    }
+
+    // Гибкие пробелы в тексте после последнего плейсхолдера
+    {
+        constexpr format_string<"t = {%d} ms",
+            format_options::flexible_whitespace> format;
+        static_assert(!scan<format, int>("t=\t7   ms"sv));
+        static_assert(std::get<0>(scan<format, int>("t \t= 7   ms"sv)->values) == 7);
+        static_assert(!scan<format, int>("t = 7ms"sv));
+        static_assert(!scan<format, int>("t = 7 ms "sv));
+    }
+
+    // Формат без плейсхолдеров совпадает с источником целиком
+    {
+        constexpr format_string<"header"> format;
+        static_assert(scan<format>("header"sv));
+        static_assert(!scan<format>("header2"sv));
+        static_assert(!scan<format>("heade"sv));
+    }
+
+    // На этапе компиляции те же правила
+    {
+        constexpr auto result = scan<format_string<"<{%d}|{%d}>">{}, "<1|2>", int, int>();
+        static_assert(std::get<0>(result.values) == 1 && std::get<1>(result.values) == 2);
+    }
+
+    /* Не скомпилируется
+    {
+        constexpr auto prefix = scan<format_string<"<{%d}|{%d}>">{}, "(1|2>", int, int>();
+        constexpr auto separator = scan<format_string<"<{%d}|{%d}>">{}, "<1;2>", int, int>();
+        constexpr auto suffix = scan<format_string<"<{%d}|{%d}>">{}, "<1|2)", int, int>();
+        constexpr auto length = scan<format_string<"<{%d}|{%d}>">{}, "<|", int, int>();
+    }
+    */
+
+    // Форматирующие строки времени исполнения и пакетное сканирование
+    {
+        const std::expected format = compiled_format::compile("id={%d}, t={%f} ms"sv);
+        const std::expected empty = compiled_format::compile("header"sv);
+        if (!format || !empty ||
+            !format->scan<int, double>("id=1, t=2.5 ms"sv) ||
+            format->scan<int, double>("ID=1, t=2.5 ms"sv).error().code !=
+                mismatch_reason::literal_mismatch ||
+            format->scan<int, double>("id=1, t=2.5 s"sv) ||
+            format->scan<int, double>("id=1; t=2.5 ms"sv).error() !=
+                scan_error{ 3, 0, mismatch_reason::literal_mismatch } ||
+            format->scan<int, double>("id="sv) ||
+            !empty->scan<>("header"sv) || empty->scan<>("header2"sv))
+        {
+            std::abort();
+        }
+
+        const std::string_view records[] = {
+            "id=1, t=2.5 ms"sv, "xx=1, t=2.5 ms"sv, "id=1, t=2.5"sv, "id=1 t=2.5 ms"sv };
+        const auto batch = scan_batch<format_string<"id={%d}, t={%f} ms">{},
+            int, double>(records);
+        if (batch.valid != std::vector<uint8_t>{ 1, 0, 0, 0 } ||
+            batch.column<1>()[0] != 2.5)
+        {
+            std::abort();
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     FixedString_Tests();
@@ -437,4 +1671,20 @@ int main(int argc, char* argv[])
     Composite_Parse_Tests();
 
     Scan_Tests();
+    Quoted_Tests();
+    Print_Tests();
+
+    Convert_Tests();
+    Runtime_Scan_Tests();
+    Compiled_Format_Tests();
+    Scan_All_Tests();
+    Field_Index_Tests();
+    Batch_Tests();
+    Instrumentation_Tests();
+    Wide_Tests();
+    Flexible_Whitespace_Tests();
+    Scan_Error_Tests();
+    Shape_Tests();
+    Packed_Tests();
+    Anchoring_Tests();
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+import stdx.scan;
+
+/* Проверка интерфейса модуля: единица трансляции получает библиотеку
+только через import stdx.scan, без заголовков.  Собирается и
+запускается при SCAN_BUILD_MODULE=ON */
+
+using namespace std::string_view_literals;
+
+void Consteval_Import_Tests()
+{
+    constexpr stdx::format_string<"id={%d} name={%s} t={%f}"> format;
+
+    constexpr auto result = stdx::scan<format, "id=7 name=alice t=2.5",
+        int, std::string_view, double>();
+    static_assert(std::get<0>(result.values) == 7);
+    static_assert(std::get<1>(result.values) == "alice"sv);
+    static_assert(std::get<2>(result.values) == 2.5);
+}
+
+void Runtime_Import_Tests()
+{
+    constexpr stdx::format_string<"{%d};{%u};{%s}"> format;
+
+    // Круговая проверка print_to и scan во время исполнения
+    {
+        char buffer[64];
+        char* end = stdx::print_to<format>(buffer, -42, 17u, "WORD"sv);
+        const auto result = stdx::scan<format, int, unsigned, std::string_view>(
+            { buffer, static_cast<size_t>(end - buffer) });
+
+        if (!result || std::get<0>(result->values) != -42 ||
+            std::get<1>(result->values) != 17u ||
+            std::get<2>(result->values) != "WORD"sv)
+        {
+            std::abort();
+        }
+    }
+
+    // Ошибка сканирования доступна через экспортированный scan_error
+    {
+        const auto result = stdx::scan<format, int, unsigned, std::string_view>("x;1;a"sv);
+        if (result || result.error().placeholder != 0) std::abort();
+    }
+
+    // Пакетное сканирование и упакованные записи
+    {
+        const std::string_view records[] = { "1;2;a"sv, "3;4;b"sv };
+        const auto batch = stdx::scan_batch<format, int, unsigned,
+            std::string_view>(records);
+        if (batch.size() != 2 || batch.column<0>()[1] != 3 ||
+            batch.column<2>()[0] != "a"sv)
+        {
+            std::abort();
+        }
+
+        using record = stdx::packed_record<int, unsigned, std::string_view>;
+        const auto result = stdx::scan<format, int, unsigned, std::string_view>(records[1]);
+        const std::optional<record> packed = record::pack(*result, records[1]);
+        if (!packed || packed->get<0>() != 3 || packed->get<2>(records[1]) != "b"sv)
+        {
+            std::abort();
+        }
+    }
+}
+
+int main()
+{
+    Consteval_Import_Tests();
+    Runtime_Import_Tests();
+}